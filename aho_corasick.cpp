@@ -0,0 +1,139 @@
+#include "aho_corasick.h"
+
+const int32_t AhoCorasick::NONE;
+const size_t AhoCorasick::ALPHABET;
+
+AhoCorasick::AhoCorasick(std::initializer_list<StringView> patterns)
+    : AhoCorasick(patterns.begin(), patterns.end()) {}
+
+size_t AhoCorasick::patternCount() const {
+    return lengths_.size();
+}
+
+size_t AhoCorasick::stateCount() const {
+    return output_.size();
+}
+
+size_t AhoCorasick::classCount() const {
+    return stride_;
+}
+
+std::vector<AhoCorasick::Match> AhoCorasick::findAll(const StringView& text) const {
+    std::vector<Match> result;
+    scan(text, [&result](const Match& match) { result.push_back(match); });
+    return result;
+}
+
+bool AhoCorasick::containsAny(const StringView& text) const {
+    bool found = false;
+    scan(text, [&found](const Match&) { return !(found = true); });
+    return found;
+}
+
+int32_t AhoCorasick::newState() {
+    next_.resize(next_.size() + ALPHABET, NONE);
+    output_.push_back(NONE);
+    dictionary_.push_back(NONE);
+    terminal_.push_back(0);
+    return static_cast<int32_t>(output_.size() - 1);
+}
+
+void AhoCorasick::add(const StringView& pattern) {
+    int32_t id = static_cast<int32_t>(lengths_.size());
+    lengths_.push_back(pattern.size());
+    same_pattern_.push_back(NONE);
+    if (pattern.empty()) {
+        return;
+    }
+    int32_t state = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        size_t ch = static_cast<unsigned char>(pattern[i]);
+        used_[ch] = true;
+        if (next_[static_cast<size_t>(state) * ALPHABET + ch] == NONE) {
+            int32_t child = newState();
+            next_[static_cast<size_t>(state) * ALPHABET + ch] = child;
+        }
+        state = next_[static_cast<size_t>(state) * ALPHABET + ch];
+    }
+    same_pattern_[id] = output_[state];
+    output_[state] = id;
+    starts_[static_cast<unsigned char>(pattern[0])] = true;
+}
+
+// Breadth-first pass that turns the trie into a complete automaton: a
+// missing edge is replaced by the edge of the failure state, which is
+// shallower and therefore already complete.
+void AhoCorasick::build() {
+    std::vector<int32_t> fail(output_.size(), 0);
+    std::vector<int32_t> queue;
+    queue.reserve(output_.size());
+    for (size_t ch = 0; ch < ALPHABET; ++ch) {
+        int32_t& child = next_[ch];
+        if (child == NONE) {
+            child = 0;
+        } else {
+            queue.push_back(child);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int32_t state = queue[head];
+        size_t row = static_cast<size_t>(state) * ALPHABET;
+        size_t fail_row = static_cast<size_t>(fail[state]) * ALPHABET;
+        for (size_t ch = 0; ch < ALPHABET; ++ch) {
+            int32_t child = next_[row + ch];
+            if (child == NONE) {
+                next_[row + ch] = next_[fail_row + ch];
+                continue;
+            }
+            int32_t suffix = next_[fail_row + ch];
+            fail[child] = suffix;
+            dictionary_[child] = (output_[suffix] != NONE ? suffix : dictionary_[suffix]);
+            queue.push_back(child);
+        }
+    }
+    for (size_t state = 0; state < output_.size(); ++state) {
+        terminal_[state] = (output_[state] != NONE || dictionary_[state] != NONE);
+    }
+    compress();
+    int starts = 0;
+    for (size_t ch = 0; ch < ALPHABET; ++ch) {
+        if (starts_[ch]) {
+            ++starts;
+            single_start_ = static_cast<int>(ch);
+        }
+    }
+    if (starts != 1) {
+        single_start_ = NONE;
+    }
+}
+
+// Narrows the 256-column rows to one column per byte class. Bytes that
+// occur in no pattern lead back to the root from every state, so they
+// all share the last column.
+void AhoCorasick::compress() {
+    size_t count = 0;
+    size_t representative[ALPHABET];
+    for (size_t ch = 0; ch < ALPHABET; ++ch) {
+        if (used_[ch]) {
+            representative[count] = ch;
+            classes_[ch] = static_cast<uint8_t>(count++);
+        }
+    }
+    if (count < ALPHABET) {
+        for (size_t ch = 0; ch < ALPHABET; ++ch) {
+            if (!used_[ch]) {
+                classes_[ch] = static_cast<uint8_t>(count);
+                representative[count] = ch;
+            }
+        }
+        ++count;
+    }
+    std::vector<int32_t> compressed(output_.size() * count);
+    for (size_t state = 0; state < output_.size(); ++state) {
+        for (size_t cls = 0; cls < count; ++cls) {
+            compressed[state * count + cls] = next_[state * ALPHABET + representative[cls]];
+        }
+    }
+    next_.swap(compressed);
+    stride_ = count;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+#include "string.h"
+
+// Matches a fixed set of patterns against a text in a single pass. The
+// automaton is compiled to a dense transition table, so each input byte
+// costs one lookup regardless of the number of patterns. Columns are byte
+// classes (bytes that occur in some pattern get their own, the rest share
+// one), which keeps the table small enough to stay in cache.
+// Patterns are numbered in the order they are given; empty patterns
+// never match.
+class AhoCorasick {
+  public:
+    struct Match {
+        size_t pattern;
+        size_t position;
+    };
+
+    AhoCorasick(std::initializer_list<StringView> patterns);
+    template <typename Iterator>
+    AhoCorasick(Iterator first, Iterator last);
+
+    size_t patternCount() const;
+    size_t stateCount() const;
+
+    // Calls `on_match(Match)` for every occurrence, overlapping ones
+    // included, in order of their end position.
+    template <typename Func>
+    void scan(const StringView& text, Func on_match) const;
+    std::vector<Match> findAll(const StringView& text) const;
+    bool containsAny(const StringView& text) const;
+
+  private:
+    static const int32_t NONE = -1;
+    static const size_t ALPHABET = 256;
+
+    void add(const StringView& pattern);
+    void build();
+    void compress();
+    int32_t newState();
+    template <typename Func>
+    bool report(int32_t state, size_t end, Func& on_match) const;
+
+    size_t classCount() const;
+
+    std::vector<int32_t> next_;
+    std::vector<int32_t> output_;
+    std::vector<int32_t> dictionary_;
+    std::vector<uint8_t> terminal_;
+    std::vector<size_t> lengths_;
+    std::vector<int32_t> same_pattern_;
+    // First bytes of the patterns; with just one, the scan jumps between
+    // its occurrences with memchr while the automaton is at the root.
+    bool starts_[ALPHABET] = {};
+    int single_start_ = NONE;
+    bool used_[ALPHABET] = {};
+    uint8_t classes_[ALPHABET] = {};
+    size_t stride_ = ALPHABET;
+};
+
+template <typename Iterator>
+AhoCorasick::AhoCorasick(Iterator first, Iterator last) {
+    newState();
+    for (; first != last; ++first) {
+        add(StringView(*first));
+    }
+    build();
+}
+
+// `on_match` may return false to stop the scan early; any other return
+// type (including void) keeps going.
+template <typename Func>
+bool AhoCorasick::report(int32_t state, size_t end, Func& on_match) const {
+    for (; state != NONE; state = dictionary_[state]) {
+        for (int32_t id = output_[state]; id != NONE; id = same_pattern_[id]) {
+            Match match{static_cast<size_t>(id), end - lengths_[id]};
+            if constexpr (std::is_same<decltype(on_match(match)), bool>::value) {
+                if (!on_match(match)) {
+                    return false;
+                }
+            } else {
+                on_match(match);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Func>
+void AhoCorasick::scan(const StringView& text, Func on_match) const {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t size = text.size();
+    const int32_t* next = next_.data();
+    const size_t stride = stride_;
+    int32_t state = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (state == 0) {
+            if (single_start_ != NONE) {
+                const void* hit = memchr(data + i, single_start_, size - i);
+                if (hit == nullptr) {
+                    return;
+                }
+                i = static_cast<size_t>(static_cast<const unsigned char*>(hit) - data);
+            } else {
+                while (i < size && !starts_[data[i]]) {
+                    ++i;
+                }
+                if (i == size) {
+                    return;
+                }
+            }
+        }
+        state = next[static_cast<size_t>(state) * stride + classes_[data[i]]];
+        if (terminal_[state] != 0 && !report(state, i + 1, on_match)) {
+            return;
+        }
+    }
+}
@@ -1,4 +1,571 @@
 #include "biginteger.h"
+#include <cmath>
+#include <istream>
+#include <memory>
+#include <tuple>
+#include "thread_pool.h"
+
+namespace {
+
+using Limbs = std::vector<uint64_t>;
+using uint128_t = unsigned __int128;
+
+void limbs_trim(Limbs& a) {
+    while (a.size() > 1 && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+size_t limbs_bit_length(const Limbs& a) {
+    for (size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] != 0) {
+            return (i - 1) * 64 + 64 - __builtin_clzll(a[i - 1]);
+        }
+    }
+    return 0;
+}
+
+bool limbs_bit(const Limbs& a, size_t i) {
+    return i / 64 < a.size() && ((a[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+bool limbs_less(const uint64_t* a, const uint64_t* b, size_t n) {
+    for (size_t i = n; i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1];
+        }
+    }
+    return false;
+}
+
+uint64_t limbs_sub(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint128_t diff = uint128_t(a[i]) - b[i] - borrow;
+        out[i] = static_cast<uint64_t>(diff);
+        borrow = static_cast<uint64_t>(diff >> 64) & 1;
+    }
+    return borrow;
+}
+
+// out = (mask ? a : b), without branching on mask.
+void limbs_select(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n, uint64_t mask) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = (a[i] & mask) | (b[i] & ~mask);
+    }
+}
+
+uint64_t serial_load64(const char* data) {
+    uint64_t word = 0;
+    for (size_t i = 8; i > 0; --i) {
+        word = (word << 8) | static_cast<unsigned char>(data[i - 1]);
+    }
+    return word;
+}
+
+uint64_t limbs_mix(uint64_t a, uint64_t b) {
+    uint128_t product = uint128_t(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+// a = 2^(64 * a.size()) - a, i.e. two's complement negation in place.
+void limbs_negate(Limbs& a) {
+    uint64_t carry = 1;
+    for (uint64_t& limb : a) {
+        limb = ~limb + carry;
+        carry = (carry != 0 && limb == 0 ? 1 : 0);
+    }
+}
+
+Limbs limbs_multiply(const uint64_t* a, size_t n, const uint64_t* b, size_t k) {
+    Limbs result(n + k, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < k; ++j) {
+            uint128_t cur = uint128_t(a[i]) * b[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint64_t>(cur);
+            carry = static_cast<uint64_t>(cur >> 64);
+        }
+        result[i + k] = carry;
+    }
+    return result;
+}
+
+// Bit-serial long division, only used for one-off setup and for operands
+// larger than the modulus. Returns the remainder (m.size() limbs) and
+// stores the quotient if asked.
+Limbs limbs_divide(const Limbs& x, const Limbs& m, Limbs* quotient = nullptr) {
+    size_t n = m.size();
+    Limbs rem(n + 1, 0);
+    Limbs wide_m(m);
+    wide_m.push_back(0);
+    size_t bits = limbs_bit_length(x);
+    if (quotient != nullptr) {
+        quotient->assign(x.size(), 0);
+    }
+    for (size_t i = bits; i > 0; --i) {
+        for (size_t j = n + 1; j > 1; --j) {
+            rem[j - 1] = (rem[j - 1] << 1) | (rem[j - 2] >> 63);
+        }
+        rem[0] = (rem[0] << 1) | (limbs_bit(x, i - 1) ? 1 : 0);
+        if (!limbs_less(rem.data(), wide_m.data(), n + 1)) {
+            limbs_sub(rem.data(), rem.data(), wide_m.data(), n + 1);
+            if (quotient != nullptr) {
+                (*quotient)[(i - 1) / 64] |= uint64_t(1) << ((i - 1) % 64);
+            }
+        }
+    }
+    rem.pop_back();
+    return rem;
+}
+
+// Reduces a BigInteger of any sign into [0, m).
+Limbs limbs_reduce(const BigInteger& x, const Limbs& m, const Limbs& binary) {
+    Limbs rem = limbs_divide(binary, m);
+    bool zero = (limbs_bit_length(rem) == 0);
+    if (x.getSign() == Sign::NEGATIVE && !zero) {
+        limbs_sub(rem.data(), m.data(), rem.data(), m.size());
+    }
+    return rem;
+}
+
+size_t limbs_window_width(size_t bits) {
+    return (bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1);
+}
+
+// Left-to-right exponentiation over a modular multiplication `mul`.
+// The variable-time path uses sliding windows over odd powers; the
+// constant-time path uses fixed 4-bit windows over every exponent bit
+// and reads each table entry through a mask.
+template <typename Mul>
+Limbs limbs_pow(const Mul& mul, const Limbs& base, const Limbs& one, const Limbs& exponent,
+                bool constant_time) {
+    size_t n = one.size();
+    if (constant_time) {
+        const size_t width = 4;
+        std::vector<Limbs> table(size_t(1) << width);
+        table[0] = one;
+        for (size_t i = 1; i < table.size(); ++i) {
+            table[i] = mul(table[i - 1], base);
+        }
+        Limbs result = one;
+        Limbs selected(n);
+        for (size_t pos = exponent.size() * 64; pos > 0; pos -= width) {
+            for (size_t i = 0; i < width; ++i) {
+                result = mul(result, result);
+            }
+            uint64_t window = (exponent[(pos - width) / 64] >> ((pos - width) % 64)) & 15;
+            for (size_t i = 0; i < table.size(); ++i) {
+                uint64_t mask = 0 - (((i ^ window) - 1) >> 63);
+                limbs_select(selected.data(), table[i].data(), selected.data(), n, mask);
+            }
+            result = mul(result, selected);
+        }
+        return result;
+    }
+    size_t bits = limbs_bit_length(exponent);
+    size_t width = limbs_window_width(bits);
+    std::vector<Limbs> odd_powers(size_t(1) << (width - 1));
+    odd_powers[0] = base;
+    if (odd_powers.size() > 1) {
+        Limbs square = mul(base, base);
+        for (size_t i = 1; i < odd_powers.size(); ++i) {
+            odd_powers[i] = mul(odd_powers[i - 1], square);
+        }
+    }
+    Limbs result = one;
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+        if (!limbs_bit(exponent, i - 1)) {
+            if (started) {
+                result = mul(result, result);
+            }
+            --i;
+            continue;
+        }
+        size_t low = (i > width ? i - width : 0);
+        while (!limbs_bit(exponent, low)) {
+            ++low;
+        }
+        size_t value = 0;
+        for (size_t k = i; k > low; --k) {
+            value = (value << 1) | (limbs_bit(exponent, k - 1) ? 1 : 0);
+            if (started) {
+                result = mul(result, result);
+            }
+        }
+        result = (started ? mul(result, odd_powers[value >> 1]) : odd_powers[value >> 1]);
+        started = true;
+        i = low;
+    }
+    return result;
+}
+
+const int64_t DECIMAL_BASE = 1000000000;
+const size_t KARATSUBA_THRESHOLD = 40;
+const size_t NTT_THRESHOLD = 3000;
+const size_t NTT_MAX_LENGTH = size_t(1) << 23;
+const size_t NTT_GRAIN = size_t(1) << 14;
+const size_t NEWTON_THRESHOLD = 2000;
+// Above these many 64-bit limbs the binary conversions split in halves.
+const size_t TO_BINARY_SPLIT_LIMBS = 8192;
+const size_t FROM_BINARY_SPLIT_LIMBS = 64;
+const int64_t DECIMAL_POWERS[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+std::unique_ptr<ThreadPool> decimal_pool;
+size_t decimal_parallel_threshold = 2048;
+
+ThreadPool* decimal_parallel(size_t limbs) {
+    return (limbs >= decimal_parallel_threshold ? decimal_pool.get() : nullptr);
+}
+
+// Adds src into dst, propagating the carry; the sum must fit in dst.
+void decimal_add_into(int64_t* dst, size_t dst_size, const int64_t* src, size_t src_size) {
+    int64_t carry = 0;
+    for (size_t i = 0; i < dst_size && (i < src_size || carry != 0); ++i) {
+        dst[i] += (i < src_size ? src[i] : 0) + carry;
+        carry = (dst[i] >= DECIMAL_BASE ? 1 : 0);
+        dst[i] -= carry * DECIMAL_BASE;
+    }
+}
+
+// Subtracts src from dst, which must not be smaller.
+void decimal_sub_from(int64_t* dst, size_t dst_size, const int64_t* src, size_t src_size) {
+    int64_t borrow = 0;
+    for (size_t i = 0; i < dst_size && (i < src_size || borrow != 0); ++i) {
+        dst[i] -= (i < src_size ? src[i] : 0) + borrow;
+        borrow = (dst[i] < 0 ? 1 : 0);
+        dst[i] += borrow * DECIMAL_BASE;
+    }
+}
+
+// Rows are accumulated unnormalized and carried every eight rows, which
+// is as far as (10^9)^2 sums can go without overflowing int64_t.
+void decimal_schoolbook(const int64_t* a, size_t n, const int64_t* b, size_t m, int64_t* out) {
+    std::fill(out, out + n + m, 0);
+    for (size_t i = 0; i < n; ++i) {
+        int64_t digit = a[i];
+        int64_t* row = out + i;
+        for (size_t j = 0; j < m; ++j) {
+            row[j] += digit * b[j];
+        }
+        if ((i & 7) == 7 || i + 1 == n) {
+            int64_t carry = 0;
+            for (size_t k = i - (i & 7); k < i + m; ++k) {
+                int64_t cur = out[k] + carry;
+                carry = cur / DECIMAL_BASE;
+                out[k] = cur % DECIMAL_BASE;
+            }
+            out[i + m] += carry;
+        }
+    }
+}
+
+// a and b have n limbs each, out gets 2n. The three half-size products
+// run in parallel when the operands are large enough.
+void decimal_karatsuba(const int64_t* a, const int64_t* b, size_t n, int64_t* out) {
+    if (n <= KARATSUBA_THRESHOLD) {
+        decimal_schoolbook(a, n, b, n, out);
+        return;
+    }
+    size_t low = n / 2;
+    size_t high = n - low;
+    std::vector<int64_t> sum_a(a + low, a + n);
+    std::vector<int64_t> sum_b(b + low, b + n);
+    sum_a.push_back(0);
+    sum_b.push_back(0);
+    decimal_add_into(sum_a.data(), high + 1, a, low);
+    decimal_add_into(sum_b.data(), high + 1, b, low);
+    std::vector<int64_t> middle(2 * (high + 1));
+    auto low_part = [&] { decimal_karatsuba(a, b, low, out); };
+    auto high_part = [&] { decimal_karatsuba(a + low, b + low, high, out + 2 * low); };
+    auto middle_part = [&] {
+        decimal_karatsuba(sum_a.data(), sum_b.data(), high + 1, middle.data());
+    };
+    if (ThreadPool* pool = decimal_parallel(n)) {
+        pool->parallelInvoke(middle_part, [&] { pool->parallelInvoke(low_part, high_part); });
+    } else {
+        low_part();
+        high_part();
+        middle_part();
+    }
+    decimal_sub_from(middle.data(), middle.size(), out, 2 * low);
+    decimal_sub_from(middle.data(), middle.size(), out + 2 * low, 2 * high);
+    size_t middle_size = middle.size();
+    while (middle_size > 0 && middle[middle_size - 1] == 0) {
+        --middle_size;
+    }
+    decimal_add_into(out + low, 2 * n - low, middle.data(), middle_size);
+}
+
+template <uint32_t MOD>
+uint32_t ntt_pow(uint64_t value, uint64_t exponent) {
+    uint64_t result = 1;
+    for (value %= MOD; exponent != 0; exponent >>= 1, value = value * value % MOD) {
+        if ((exponent & 1) != 0) {
+            result = result * value % MOD;
+        }
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// In-place iterative radix-2 transform; the butterflies of each pass are
+// independent and split over the pool.
+template <uint32_t MOD, uint32_t ROOT>
+void ntt_transform(std::vector<uint32_t>& a, bool invert, ThreadPool* pool) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; (j & bit) != 0; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    std::vector<uint32_t> roots(n / 2 + 1, 1);
+    uint32_t root = ntt_pow<MOD>(ROOT, (MOD - 1) / n);
+    if (invert) {
+        root = ntt_pow<MOD>(root, MOD - 2);
+    }
+    for (size_t i = 1; i < roots.size(); ++i) {
+        roots[i] = static_cast<uint32_t>(uint64_t(roots[i - 1]) * root % MOD);
+    }
+    for (size_t length = 2; length <= n; length <<= 1) {
+        size_t half = length / 2;
+        size_t shift = __builtin_ctzll(half);
+        size_t stride = n / length;
+        auto butterfly = [&](size_t k) {
+            size_t j = k & (half - 1);
+            size_t i = ((k >> shift) << (shift + 1)) + j;
+            uint32_t u = a[i];
+            uint32_t v = static_cast<uint32_t>(uint64_t(a[i + half]) * roots[j * stride] % MOD);
+            a[i] = (u + v >= MOD ? u + v - MOD : u + v);
+            a[i + half] = (u >= v ? u - v : u + MOD - v);
+        };
+        if (pool != nullptr) {
+            pool->parallelFor(0, n / 2, NTT_GRAIN, butterfly);
+        } else {
+            for (size_t k = 0; k < n / 2; ++k) {
+                butterfly(k);
+            }
+        }
+    }
+    if (invert) {
+        uint64_t inverse = ntt_pow<MOD>(n, MOD - 2);
+        for (uint32_t& value : a) {
+            value = static_cast<uint32_t>(value * inverse % MOD);
+        }
+    }
+}
+
+template <uint32_t MOD, uint32_t ROOT>
+std::vector<uint32_t> ntt_convolve(const int64_t* a, size_t n, const int64_t* b, size_t m,
+                                   size_t size, ThreadPool* pool) {
+    std::vector<uint32_t> fa(size, 0);
+    std::vector<uint32_t> fb(size, 0);
+    for (size_t i = 0; i < n; ++i) {
+        fa[i] = static_cast<uint32_t>(a[i] % MOD);
+    }
+    for (size_t i = 0; i < m; ++i) {
+        fb[i] = static_cast<uint32_t>(b[i] % MOD);
+    }
+    if (pool != nullptr) {
+        pool->parallelInvoke([&] { ntt_transform<MOD, ROOT>(fa, false, pool); },
+                             [&] { ntt_transform<MOD, ROOT>(fb, false, pool); });
+    } else {
+        ntt_transform<MOD, ROOT>(fa, false, pool);
+        ntt_transform<MOD, ROOT>(fb, false, pool);
+    }
+    for (size_t i = 0; i < size; ++i) {
+        fa[i] = static_cast<uint32_t>(uint64_t(fa[i]) * fb[i] % MOD);
+    }
+    ntt_transform<MOD, ROOT>(fa, true, pool);
+    return fa;
+}
+
+// Convolution modulo three NTT primes, recombined with Garner's CRT:
+// their product (~7.9e25) exceeds any column sum of up to 2^23 products
+// of limbs below 10^9. The carry into base 10^9 stays within uint64_t by
+// splitting P1*P2 into 10^9 halves.
+void decimal_ntt_multiply(const int64_t* a, size_t n, const int64_t* b, size_t m, int64_t* out) {
+    const uint32_t P1 = 998244353;
+    const uint32_t P2 = 167772161;
+    const uint32_t P3 = 469762049;
+    size_t size = 1;
+    while (size < n + m) {
+        size <<= 1;
+    }
+    ThreadPool* pool = decimal_parallel(n + m);
+    std::vector<uint32_t> r1, r2, r3;
+    auto first = [&] { r1 = ntt_convolve<P1, 3>(a, n, b, m, size, pool); };
+    auto second = [&] { r2 = ntt_convolve<P2, 3>(a, n, b, m, size, pool); };
+    auto third = [&] { r3 = ntt_convolve<P3, 3>(a, n, b, m, size, pool); };
+    if (pool != nullptr) {
+        pool->parallelInvoke(first, [&] { pool->parallelInvoke(second, third); });
+    } else {
+        first();
+        second();
+        third();
+    }
+    const uint64_t inv_p1 = ntt_pow<P2>(P1, P2 - 2);
+    const uint64_t p1p2 = uint64_t(P1) * P2;
+    const uint64_t inv_p1p2 = ntt_pow<P3>(p1p2 % P3, P3 - 2);
+    const uint64_t p1p2_high = p1p2 / DECIMAL_BASE;
+    const uint64_t p1p2_low = p1p2 % DECIMAL_BASE;
+    uint64_t carry = 0;
+    for (size_t k = 0; k < n + m; ++k) {
+        uint64_t x12 = r1[k] + P1 * ((r2[k] + P2 - r1[k] % P2) % P2 * inv_p1 % P2);
+        uint64_t t = (r3[k] + P3 - x12 % P3) % P3 * inv_p1p2 % P3;
+        uint64_t low = x12 + carry + t * p1p2_low;
+        out[k] = static_cast<int64_t>(low % DECIMAL_BASE);
+        carry = low / DECIMAL_BASE + t * p1p2_high;
+    }
+}
+
+// out gets n + m limbs.
+void decimal_multiply(const int64_t* a, size_t n, const int64_t* b, size_t m, int64_t* out) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m <= KARATSUBA_THRESHOLD) {
+        decimal_schoolbook(b, m, a, n, out);
+        return;
+    }
+    if (n + m >= NTT_THRESHOLD && n + m <= NTT_MAX_LENGTH) {
+        decimal_ntt_multiply(a, n, b, m, out);
+        return;
+    }
+    std::fill(out, out + n + m, 0);
+    std::vector<int64_t> part(2 * m);
+    for (size_t i = 0; i < n; i += m) {
+        size_t count = std::min(m, n - i);
+        if (count == m) {
+            decimal_karatsuba(a + i, b, m, part.data());
+        } else {
+            decimal_multiply(b, m, a + i, count, part.data());
+        }
+        decimal_add_into(out + i, n + m - i, part.data(), m + count);
+    }
+}
+
+// Knuth's algorithm D in base 10^9: u = q * v + r with v's top limb
+// non-zero. Both are scaled so that v's top limb is at least 10^9 / 2,
+// which makes each estimated quotient limb at most two too large.
+void decimal_divide(const std::vector<int64_t>& u_in, const std::vector<int64_t>& v_in,
+                    std::vector<int64_t>& q, std::vector<int64_t>& r) {
+    size_t n = v_in.size();
+    size_t m = u_in.size() - n;
+    q.assign(m + 1, 0);
+    if (n == 1) {
+        int64_t rem = 0;
+        for (size_t i = u_in.size(); i > 0; --i) {
+            int64_t cur = rem * DECIMAL_BASE + u_in[i - 1];
+            q[i - 1] = cur / v_in[0];
+            rem = cur % v_in[0];
+        }
+        r.assign(1, rem);
+        return;
+    }
+    int64_t scale = DECIMAL_BASE / (v_in.back() + 1);
+    auto scaled = [scale](const std::vector<int64_t>& x, size_t size) {
+        std::vector<int64_t> result(size, 0);
+        int64_t carry = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            int64_t cur = x[i] * scale + carry;
+            result[i] = cur % DECIMAL_BASE;
+            carry = cur / DECIMAL_BASE;
+        }
+        if (x.size() < size) {
+            result[x.size()] = carry;
+        }
+        return result;
+    };
+    std::vector<int64_t> u = scaled(u_in, u_in.size() + 1);
+    std::vector<int64_t> v = scaled(v_in, n);
+    for (size_t j = m + 1; j > 0; --j) {
+        int64_t* window = u.data() + j - 1;
+        int64_t top = window[n] * DECIMAL_BASE + window[n - 1];
+        int64_t estimate = top / v[n - 1];
+        int64_t rest = top % v[n - 1];
+        while (estimate >= DECIMAL_BASE ||
+               estimate * v[n - 2] > rest * DECIMAL_BASE + window[n - 2]) {
+            --estimate;
+            rest += v[n - 1];
+            if (rest >= DECIMAL_BASE) {
+                break;
+            }
+        }
+        int64_t carry = 0;
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t product = estimate * v[i] + carry;
+            carry = product / DECIMAL_BASE;
+            int64_t cur = window[i] - product % DECIMAL_BASE - borrow;
+            borrow = (cur < 0 ? 1 : 0);
+            window[i] = cur + borrow * DECIMAL_BASE;
+        }
+        int64_t cur = window[n] - carry - borrow;
+        window[n] = cur;
+        if (cur < 0) {
+            --estimate;
+            window[n] += DECIMAL_BASE;
+            decimal_add_into(window, n + 1, v.data(), n);
+        }
+        q[j - 1] = estimate;
+    }
+    r.assign(n, 0);
+    int64_t rem = 0;
+    for (size_t i = n; i > 0; --i) {
+        int64_t cur = rem * DECIMAL_BASE + u[i - 1];
+        r[i - 1] = cur / scale;
+        rem = cur % scale;
+    }
+}
+
+// Multiplies factor into the last word while it stays below 2^63. Only a
+// factor that is itself 2^63 or more gets a word of that size.
+void decimal_pack(std::vector<uint64_t>& words, uint64_t factor) {
+    uint64_t product = 0;
+    if (words.empty() || __builtin_mul_overflow(words.back(), factor, &product) ||
+        product > INT64_MAX) {
+        words.push_back(factor);
+    } else {
+        words.back() = product;
+    }
+}
+
+BigInteger decimal_word(uint64_t word) {
+    if (word <= INT64_MAX) {
+        return static_cast<int64_t>(word);
+    }
+    return BigInteger(static_cast<int64_t>(word / DECIMAL_BASE)) * DECIMAL_BASE +
+           static_cast<int64_t>(word % DECIMAL_BASE);
+}
+
+// Product of words[begin, end) as a balanced tree, so that the large
+// multiplications are between operands of similar size.
+BigInteger decimal_product(const std::vector<uint64_t>& words, size_t begin, size_t end) {
+    if (end - begin <= 1) {
+        return (begin == end ? 1 : decimal_word(words[begin]));
+    }
+    size_t middle = begin + (end - begin) / 2;
+    BigInteger left;
+    BigInteger right;
+    auto left_part = [&] { left = decimal_product(words, begin, middle); };
+    auto right_part = [&] { right = decimal_product(words, middle, end); };
+    if (ThreadPool* pool = decimal_parallel(2 * (end - begin))) {
+        pool->parallelInvoke(left_part, right_part);
+    } else {
+        left_part();
+        right_part();
+    }
+    return left * right;
+}
+
+}  // namespace
 
 BigInteger::BigInteger(int64_t n) : sign_(signum(n)) {
     n = std::abs(n);
@@ -150,7 +717,7 @@ BigInteger& BigInteger::increaseForPositive(
         if (i == digits_.size()) {
             digits_.push_back(0);
         }
-        digits_[i] += other_digits[i] + carry;
+        digits_[i] += (i < other_digits.size() ? other_digits[i] : 0) + carry;
         if (digits_[i] >= base) {
             digits_[i] -= base;
             carry = 1;
@@ -221,6 +788,31 @@ BigInteger operator%(BigInteger a, const BigInteger& b) {
     return a;
 }
 
+BigInteger operator&(BigInteger a, const BigInteger& b) {
+    a &= b;
+    return a;
+}
+
+BigInteger operator|(BigInteger a, const BigInteger& b) {
+    a |= b;
+    return a;
+}
+
+BigInteger operator^(BigInteger a, const BigInteger& b) {
+    a ^= b;
+    return a;
+}
+
+BigInteger operator<<(BigInteger a, uint64_t shift) {
+    a <<= shift;
+    return a;
+}
+
+BigInteger operator>>(BigInteger a, uint64_t shift) {
+    a >>= shift;
+    return a;
+}
+
 Sign BigInteger::getSignForMultiply(const BigInteger& a, const BigInteger& b) {
     Sign sign = (a.sign_ != b.sign_ ? Sign::NEGATIVE : Sign::POSITIVE);
     if (a == 0 || b == 0) {
@@ -229,33 +821,63 @@ Sign BigInteger::getSignForMultiply(const BigInteger& a, const BigInteger& b) {
     return sign;
 }
 
-BigInteger::BigInteger(const std::string& str, size_t size) {
-    std::string tmp_str;
+BigInteger::BigInteger(const char* str, size_t size) {
     size_t stop = 0;
-    if (str[0] == '-') {
-        sign_ = Sign::NEGATIVE;
+    if (size > 0 && (str[0] == '-' || str[0] == '+')) {
+        sign_ = (str[0] == '-' ? Sign::NEGATIVE : Sign::POSITIVE);
         stop = 1;
     }
-    for (size_t i = size; i > stop; --i) {
-        tmp_str += str[i - 1];
-        if (tmp_str.size() >= BigInteger::len || i == stop + 1) {
-            std::reverse(tmp_str.begin(), tmp_str.end());
-            digits_.push_back(std::stoi(tmp_str));
-            tmp_str.clear();
+    size_t count = (size - stop + len - 1) / len;
+    digits_.assign(std::max<size_t>(count, 1), 0);
+    auto parse = [&](size_t i) {
+        size_t end = size - i * len;
+        size_t begin = (end - stop > len ? end - len : stop);
+        int64_t limb = 0;
+        for (size_t j = begin; j < end; ++j) {
+            limb = limb * 10 + (str[j] - '0');
         }
+        digits_[i] = limb;
+    };
+    if (ThreadPool* pool = decimal_parallel(count)) {
+        pool->parallelFor(0, count, NTT_GRAIN, parse);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            parse(i);
+        }
+    }
+    clearZeros();
+    if (digits_.back() == 0) {
+        sign_ = Sign::POSITIVE;
     }
 }
 
+BigInteger::BigInteger(const std::string& str, size_t size)
+    : BigInteger(str.data(), size) {}
+
 std::string BigInteger::toString() const {
     std::string result;
+    result.reserve(digits_.size() * len + 1);
     if (sign_ == Sign::NEGATIVE) {
         result += '-';
     }
     result += std::to_string(digits_.back());
-    for (size_t i = digits_.size(); i > 1; --i) {
-        std::string tmp = std::to_string(digits_[i - 2]);
-        result += std::string(len - tmp.length(), '0');
-        result += tmp;
+    size_t start = result.size();
+    size_t count = digits_.size() - 1;
+    result.resize(start + count * len);
+    auto format = [&](size_t i) {
+        int64_t limb = digits_[count - 1 - i];
+        char* out = &result[start + i * len];
+        for (size_t j = len; j > 0; --j) {
+            out[j - 1] = static_cast<char>('0' + limb % 10);
+            limb /= 10;
+        }
+    };
+    if (ThreadPool* pool = decimal_parallel(count)) {
+        pool->parallelFor(0, count, NTT_GRAIN, format);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            format(i);
+        }
     }
     return result;
 }
@@ -265,22 +887,13 @@ BigInteger::operator bool() const {
 }
 
 BigInteger& BigInteger::operator*=(const BigInteger& other) {
-    BigInteger result;
-    result.sign_ = BigInteger::getSignForMultiply(*this, other);
-    result.digits_.resize(digits_.size() + other.digits_.size(), 0);
-    for (size_t i = 0; i < digits_.size(); ++i) {
-        int64_t carry = 0;
-        for (size_t j = 0; j < other.digits_.size() || carry != 0; ++j) {
-            int64_t cur =
-                result.digits_[i + j] +
-                digits_[i] * (j < other.digits_.size() ? other.digits_[j] : 0) +
-                carry;
-            result.digits_[i + j] = cur % BigInteger::base;
-            carry = cur / BigInteger::base;
-        }
-    }
-    result.clearZeros();
-    *this = result;
+    Sign sign = BigInteger::getSignForMultiply(*this, other);
+    std::vector<int64_t> product(digits_.size() + other.digits_.size());
+    decimal_multiply(digits_.data(), digits_.size(), other.digits_.data(), other.digits_.size(),
+                     product.data());
+    digits_.swap(product);
+    clearZeros();
+    sign_ = sign;
     return *this;
 }
 
@@ -307,55 +920,738 @@ BigInteger::BigInteger(const std::string& str)
 
 std::pair<BigInteger, BigInteger> BigInteger::division(
     const BigInteger& other) {
-    BigInteger a_copy = *this;
-    BigInteger b_copy = other;
-    assert(b_copy != 0);
-
-    BigInteger result;
-    Sign sign_for_remains = a_copy.getSign();
-    Sign sign_for_result = BigInteger::getSignForMultiply(a_copy, b_copy);
-    a_copy.sign_ = Sign::POSITIVE;
-    b_copy.sign_ = Sign::POSITIVE;
-
-    result.digits_.resize(a_copy.digits_.size(), 0);
-    BigInteger cur_value;
-    for (size_t i = a_copy.digits_.size(); i > 0; --i) {
-        cur_value.multiplyBase();
-        cur_value.digits_[0] = a_copy.digits_[i - 1];
-        cur_value.clearZeros();
-        int64_t x = 0;
-        int64_t left = 0;
-        int64_t right = BigInteger::base;
-        while (left <= right) {
-            int64_t mid = (left + right) >> 1;
-            BigInteger cur = b_copy * mid;
-            if (cur <= cur_value) {
-                x = mid;
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
+    assert(other != 0);
+    BigInteger quotient = 0;
+    BigInteger remainder = *this;
+    size_t n = digits_.size();
+    size_t k = other.digits_.size();
+    if (!comparePositive(digits_, other.digits_)) {
+        if (k >= NEWTON_THRESHOLD && n - k >= NEWTON_THRESHOLD) {
+            BigInteger a = *this;
+            BigInteger b = other;
+            a.sign_ = Sign::POSITIVE;
+            b.sign_ = Sign::POSITIVE;
+            std::tie(quotient, remainder) = divideNewton(a, b);
+        } else {
+            decimal_divide(digits_, other.digits_, quotient.digits_, remainder.digits_);
+            quotient.clearZeros();
+            remainder.clearZeros();
         }
-        result.digits_[i - 1] = x;
-        cur_value -= b_copy * x;
+    }
+    quotient.sign_ =
+        (quotient.digits_.back() == 0 ? Sign::POSITIVE : getSignForMultiply(*this, other));
+    remainder.sign_ = (remainder.digits_.back() == 0 ? Sign::POSITIVE : sign_);
+    return {quotient, remainder};
+}
+
+BigInteger BigInteger::shiftLimbs(const BigInteger& x, int64_t limbs) {
+    BigInteger result = x;
+    if (limbs >= 0) {
+        result.digits_.insert(result.digits_.begin(), static_cast<size_t>(limbs), 0);
+    } else if (static_cast<size_t>(-limbs) >= x.digits_.size()) {
+        result = 0;
+    } else {
+        result.digits_.erase(result.digits_.begin(), result.digits_.begin() - limbs);
     }
     result.clearZeros();
-    if (result == 0) {
+    if (result.digits_.back() == 0) {
         result.sign_ = Sign::POSITIVE;
+    }
+    return result;
+}
+
+// floor(base^(2k) / v) for a positive v of k limbs. The reciprocal of
+// v's top half (plus a few guard limbs), scaled up, is correct to about
+// k/2 limbs; one Newton step x += x * (base^(2k) - v * x) / base^(2k)
+// doubles that, and the last few units are fixed against the exact
+// remainder.
+BigInteger BigInteger::reciprocal(const BigInteger& v) {
+    int64_t k = static_cast<int64_t>(v.digits_.size());
+    BigInteger power = shiftLimbs(1, 2 * k);
+    if (k <= 2 * static_cast<int64_t>(KARATSUBA_THRESHOLD)) {
+        BigInteger quotient;
+        BigInteger remainder;
+        decimal_divide(power.digits_, v.digits_, quotient.digits_, remainder.digits_);
+        quotient.clearZeros();
+        return quotient;
+    }
+    int64_t high = (k + 1) / 2 + 3;
+    BigInteger x = shiftLimbs(reciprocal(shiftLimbs(v, high - k)), k - high);
+    x += shiftLimbs(x * (power - v * x), -2 * k);
+    BigInteger remainder = power - v * x;
+    while (remainder.sign_ == Sign::NEGATIVE) {
+        x -= 1;
+        remainder += v;
+    }
+    while (remainder >= v) {
+        x += 1;
+        remainder -= v;
+    }
+    return x;
+}
+
+// For positive a and b with large quotients: the operands are first
+// scaled by the same power of the base so that a has at most twice as
+// many limbs as b, then q = a * floor(base^(2k) / b) / base^(2k) is at
+// most a couple of units below the true quotient. A divisor much longer
+// than the quotient is truncated first, as its low limbs barely move q.
+std::pair<BigInteger, BigInteger> BigInteger::divideNewton(const BigInteger& a,
+                                                           const BigInteger& b) {
+    int64_t n = static_cast<int64_t>(a.digits_.size());
+    int64_t k = static_cast<int64_t>(b.digits_.size());
+    int64_t dropped = k - (n - k) - 3;
+    BigInteger quotient;
+    if (dropped > 0) {
+        quotient = divideNewton(shiftLimbs(a, -dropped), shiftLimbs(b, -dropped)).first;
     } else {
-        result.sign_ = sign_for_result;
+        int64_t shift = std::max<int64_t>(0, n - 2 * k);
+        BigInteger scaled_b = shiftLimbs(b, shift);
+        quotient = shiftLimbs(shiftLimbs(a, shift) * reciprocal(scaled_b), -2 * (k + shift));
+    }
+    BigInteger remainder = a - quotient * b;
+    while (remainder.sign_ == Sign::NEGATIVE) {
+        quotient -= 1;
+        remainder += b;
     }
-    cur_value.sign_ = sign_for_remains;
-    return {result, cur_value};
+    while (remainder >= b) {
+        quotient += 1;
+        remainder -= b;
+    }
+    return {quotient, remainder};
+}
+
+void BigInteger::setThreadCount(size_t threads) {
+    decimal_pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
+void BigInteger::setParallelThreshold(size_t limbs) {
+    decimal_parallel_threshold = limbs;
 }
 
+// Reads an optional sign and digits straight from the stream buffer into
+// nine-digit chunks in reading order, which are realigned to limbs from
+// the least significant end once the length is known.
 std::istream& operator>>(std::istream& in, BigInteger& big_integer) {
-    std::string str;
-    in >> str;
-    big_integer = BigInteger(str, str.length());
+    std::istream::sentry sentry(in);
+    if (!sentry) {
+        return in;
+    }
+    std::streambuf* buf = in.rdbuf();
+    const int eof = std::char_traits<char>::eof();
+    int ch = buf->sgetc();
+    Sign sign = Sign::POSITIVE;
+    if (ch == '-' || ch == '+') {
+        sign = (ch == '-' ? Sign::NEGATIVE : Sign::POSITIVE);
+        ch = buf->snextc();
+    }
+    std::vector<int64_t> chunks;
+    int64_t chunk = 0;
+    int filled = 0;
+    while (ch >= '0' && ch <= '9') {
+        chunk = chunk * 10 + (ch - '0');
+        if (++filled == BigInteger::len) {
+            chunks.push_back(chunk);
+            chunk = 0;
+            filled = 0;
+        }
+        ch = buf->snextc();
+    }
+    if (ch == eof) {
+        in.setstate(std::ios_base::eofbit);
+    }
+    if (chunks.empty() && filled == 0) {
+        in.setstate(std::ios_base::failbit);
+        return in;
+    }
+    std::vector<int64_t>& digits = big_integer.digits_;
+    digits.resize(chunks.size() + (filled != 0 ? 1 : 0));
+    if (filled == 0) {
+        std::reverse_copy(chunks.begin(), chunks.end(), digits.begin());
+    } else {
+        // The last chunk holds `filled` digits, so every limb takes the
+        // low digits of one chunk and the high digits of the next.
+        chunks.push_back(chunk * DECIMAL_POWERS[BigInteger::len - filled]);
+        int64_t split = DECIMAL_POWERS[BigInteger::len - filled];
+        size_t m = chunks.size();
+        for (size_t t = 0; t < m; ++t) {
+            int64_t high = (t > 0 ? chunks[t - 1] % split * DECIMAL_POWERS[filled] : 0);
+            digits[m - 1 - t] = high + chunks[t] / split;
+        }
+    }
+    big_integer.clearZeros();
+    big_integer.sign_ = (digits.back() == 0 ? Sign::POSITIVE : sign);
     return in;
 }
 
+// 2^(64 * 2^k) for every k with 2^k < limbs.
+std::vector<BigInteger> BigInteger::binaryPowers(size_t limbs) {
+    std::vector<BigInteger> powers;
+    BigInteger half = static_cast<int64_t>(1) << 32;
+    for (size_t span = 1; span < limbs; span *= 2) {
+        powers.push_back(powers.empty() ? half * half : powers.back() * powers.back());
+    }
+    return powers;
+}
+
+// Writes the non-negative x < 2^(64 * size) to out[0, size), where size
+// is a power of two: the low half is x mod 2^(32 * size) and the high
+// half the quotient. Every split on a level divides by the same power of
+// k limbs, so the quotient is the top k + 2 limbs of x times the power's
+// reciprocal, at most a couple of units low.
+void BigInteger::toBinary(const BigInteger& x, const std::vector<BigInteger>& powers,
+                          const std::vector<BigInteger>& reciprocals, uint64_t* out,
+                          size_t size) {
+    if (size <= TO_BINARY_SPLIT_LIMBS) {
+        std::fill(out, out + size, 0);
+        size_t used = 0;
+        for (size_t i = x.digits_.size(); i > 0; --i) {
+            uint128_t carry = static_cast<uint64_t>(x.digits_[i - 1]);
+            for (size_t j = 0; j < used; ++j) {
+                carry += uint128_t(out[j]) * base;
+                out[j] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            if (carry != 0) {
+                out[used++] = static_cast<uint64_t>(carry);
+            }
+        }
+        return;
+    }
+    size_t half = size / 2;
+    size_t level = static_cast<size_t>(__builtin_ctzll(half));
+    const BigInteger& power = powers[level];
+    int64_t k = static_cast<int64_t>(power.digits_.size());
+    BigInteger quotient = shiftLimbs(shiftLimbs(x, 2 - k) * reciprocals[level], -k - 2);
+    BigInteger remainder = x - quotient * power;
+    while (remainder >= power) {
+        quotient += 1;
+        remainder -= power;
+    }
+    auto low_part = [&] { toBinary(remainder, powers, reciprocals, out, half); };
+    auto high_part = [&] { toBinary(quotient, powers, reciprocals, out + half, half); };
+    if (ThreadPool* pool = decimal_parallel(x.digits_.size())) {
+        pool->parallelInvoke(low_part, high_part);
+    } else {
+        low_part();
+        high_part();
+    }
+}
+
+// 9 * log2(10) < 30 bits per decimal limb.
+std::vector<uint64_t> BigInteger::toBinary() const {
+    size_t size = 1;
+    while (size * 64 < digits_.size() * 30) {
+        size *= 2;
+    }
+    std::vector<BigInteger> powers;
+    std::vector<BigInteger> reciprocals;
+    if (size > TO_BINARY_SPLIT_LIMBS) {
+        powers = binaryPowers(size / 2 + 1);
+        reciprocals.resize(powers.size());
+        // floor(base^(2k) / 2^bits) for a power of k limbs is exactly
+        // floor(5^bits / 10^(bits - 18k)), and the powers of 5 are a chain
+        // of squarings, far cheaper than a Newton reciprocal per level.
+        BigInteger five_power = pow(BigInteger(5), 64);
+        for (size_t level = 0; level < powers.size(); ++level) {
+            if (level > 0) {
+                five_power *= five_power;
+            }
+            if ((size_t(2) << level) <= TO_BINARY_SPLIT_LIMBS) {
+                continue;
+            }
+            uint64_t bits = uint64_t(64) << level;
+            uint64_t excess = bits - 2 * len * powers[level].digits_.size();
+            BigInteger scaled = shiftLimbs(five_power, -static_cast<int64_t>(excess / len));
+            reciprocals[level] = scaled / DECIMAL_POWERS[excess % len];
+        }
+    }
+    BigInteger magnitude = *this;
+    magnitude.sign_ = Sign::POSITIVE;
+    std::vector<uint64_t> result(size);
+    toBinary(magnitude, powers, reciprocals, result.data(), size);
+    limbs_trim(result);
+    if (result.empty()) {
+        result.push_back(0);
+    }
+    return result;
+}
+
+// Splits off the low 2^k limbs, the largest power of two below size.
+BigInteger BigInteger::fromBinary(const uint64_t* limbs, size_t size,
+                                  const std::vector<BigInteger>& powers) {
+    if (size <= FROM_BINARY_SPLIT_LIMBS) {
+        Limbs rest(limbs, limbs + size);
+        BigInteger result;
+        limbs_trim(rest);
+        while (rest.size() > 1 || (!rest.empty() && rest[0] != 0)) {
+            uint64_t rem = 0;
+            for (size_t i = rest.size(); i > 0; --i) {
+                uint128_t cur = (uint128_t(rem) << 64) | rest[i - 1];
+                rest[i - 1] = static_cast<uint64_t>(cur / base);
+                rem = static_cast<uint64_t>(cur % base);
+            }
+            limbs_trim(rest);
+            result.digits_.push_back(static_cast<int64_t>(rem));
+        }
+        if (result.digits_.empty()) {
+            result.digits_.push_back(0);
+        }
+        return result;
+    }
+    size_t level = 63 - static_cast<size_t>(__builtin_clzll(size - 1));
+    size_t low = size_t(1) << level;
+    BigInteger high_value;
+    BigInteger low_value;
+    auto high_part = [&] { high_value = fromBinary(limbs + low, size - low, powers); };
+    auto low_part = [&] { low_value = fromBinary(limbs, low, powers); };
+    if (ThreadPool* pool = decimal_parallel(2 * size)) {
+        pool->parallelInvoke(high_part, low_part);
+    } else {
+        high_part();
+        low_part();
+    }
+    return high_value * powers[level] + low_value;
+}
+
+BigInteger BigInteger::fromBinary(std::vector<uint64_t> limbs) {
+    limbs_trim(limbs);
+    std::vector<BigInteger> powers;
+    if (limbs.size() > FROM_BINARY_SPLIT_LIMBS) {
+        powers = binaryPowers(limbs.size());
+    }
+    return fromBinary(limbs.data(), limbs.size(), powers);
+}
+
+// Both operands are taken to two's complement one limb wider than the
+// larger magnitude, which leaves room for the sign bit.
+BigInteger BigInteger::bitwise(const BigInteger& a, const BigInteger& b, char op) {
+    Limbs x = a.toBinary();
+    Limbs y = b.toBinary();
+    size_t size = std::max(x.size(), y.size()) + 1;
+    x.resize(size, 0);
+    y.resize(size, 0);
+    if (a.sign_ == Sign::NEGATIVE) {
+        limbs_negate(x);
+    }
+    if (b.sign_ == Sign::NEGATIVE) {
+        limbs_negate(y);
+    }
+    for (size_t i = 0; i < size; ++i) {
+        x[i] = (op == '&' ? x[i] & y[i] : op == '|' ? x[i] | y[i] : x[i] ^ y[i]);
+    }
+    bool negative = (x.back() >> 63) != 0;
+    if (negative) {
+        limbs_negate(x);
+    }
+    BigInteger result = fromBinary(std::move(x));
+    if (negative) {
+        result.sign_ = Sign::NEGATIVE;
+    }
+    return result;
+}
+
+BigInteger& BigInteger::operator&=(const BigInteger& other) {
+    return *this = bitwise(*this, other, '&');
+}
+
+BigInteger& BigInteger::operator|=(const BigInteger& other) {
+    return *this = bitwise(*this, other, '|');
+}
+
+BigInteger& BigInteger::operator^=(const BigInteger& other) {
+    return *this = bitwise(*this, other, '^');
+}
+
+BigInteger& BigInteger::operator<<=(uint64_t shift) {
+    return *this *= pow(BigInteger(2), shift);
+}
+
+// Rounds toward negative infinity, like an arithmetic shift.
+BigInteger& BigInteger::operator>>=(uint64_t shift) {
+    BigInteger quotient;
+    BigInteger remainder;
+    std::tie(quotient, remainder) = division(pow(BigInteger(2), shift));
+    if (remainder.sign_ == Sign::NEGATIVE) {
+        quotient -= 1;
+    }
+    return *this = quotient;
+}
+
+BigInteger BigInteger::operator~() const {
+    BigInteger result = *this;
+    result.invert();
+    return result - 1;
+}
+
+uint64_t BigInteger::popcount() const {
+    uint64_t count = 0;
+    for (uint64_t limb : toBinary()) {
+        count += static_cast<uint64_t>(__builtin_popcountll(limb));
+    }
+    return count;
+}
+
+// Estimated from the top limbs in floating point and then checked
+// against powers of two, which avoids a full conversion to binary.
+uint64_t BigInteger::bitLength() const {
+    size_t limbs = digits_.size();
+    if (limbs == 1 && digits_[0] == 0) {
+        return 0;
+    }
+    double top = static_cast<double>(digits_[limbs - 1]);
+    if (limbs > 1) {
+        top += static_cast<double>(digits_[limbs - 2]) / base;
+    }
+    double estimate = std::log2(top) + std::log2(static_cast<double>(base)) * (limbs - 1);
+    uint64_t bits = static_cast<uint64_t>(std::max(estimate, 0.0));
+    BigInteger magnitude = *this;
+    magnitude.sign_ = Sign::POSITIVE;
+    BigInteger power = pow(BigInteger(2), bits);
+    while (magnitude < power) {
+        power /= 2;
+        --bits;
+    }
+    power *= 2;
+    while (power <= magnitude) {
+        power *= 2;
+        ++bits;
+    }
+    return bits + 1;
+}
+
+const size_t BigInteger::SERIALIZED_HEADER;
+
+// Pairs of base 10^9 limbs fit in one 64-bit word, so each multiply
+// folds in four limbs.
+size_t BigInteger::hash() const {
+    const uint64_t secret[3] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                0x8ebc6af09c88c6e3ull};
+    size_t n = digits_.size();
+    uint64_t seed = limbs_mix((n * 2 + (sign_ == Sign::NEGATIVE ? 1 : 0)) ^ secret[0], secret[1]);
+    auto word = [&](size_t i) {
+        uint64_t low = (i < n ? static_cast<uint64_t>(digits_[i]) : 0);
+        uint64_t high = (i + 1 < n ? static_cast<uint64_t>(digits_[i + 1]) : 0);
+        return low | (high << 32);
+    };
+    for (size_t i = 0; i < n; i += 4) {
+        seed = limbs_mix(word(i) ^ secret[1], word(i + 2) ^ seed);
+    }
+    return static_cast<size_t>(limbs_mix(seed ^ secret[2], n ^ secret[0]));
+}
+
+size_t BigInteger::serializedSize() const {
+    return SERIALIZED_HEADER + 4 * digits_.size();
+}
+
+size_t BigInteger::serializedSize(const char* header) {
+    return SERIALIZED_HEADER + 4 * (serial_load64(header) / 2);
+}
+
+size_t BigInteger::serialize(char* out) const {
+    uint64_t word = digits_.size() * 2 + (sign_ == Sign::NEGATIVE ? 1 : 0);
+    for (size_t i = 0; i < SERIALIZED_HEADER; ++i) {
+        out[i] = static_cast<char>(word >> (8 * i));
+    }
+    char* limb_out = out + SERIALIZED_HEADER;
+    for (int64_t digit : digits_) {
+        uint32_t limb = static_cast<uint32_t>(digit);
+        limb_out[0] = static_cast<char>(limb);
+        limb_out[1] = static_cast<char>(limb >> 8);
+        limb_out[2] = static_cast<char>(limb >> 16);
+        limb_out[3] = static_cast<char>(limb >> 24);
+        limb_out += 4;
+    }
+    return serializedSize();
+}
+
+size_t BigInteger::deserialize(const char* data, size_t size, BigInteger& result) {
+    if (size < SERIALIZED_HEADER) {
+        return 0;
+    }
+    uint64_t word = serial_load64(data);
+    uint64_t limbs = word / 2;
+    if (limbs == 0 || limbs > (size - SERIALIZED_HEADER) / 4) {
+        return 0;
+    }
+    BigInteger value;
+    value.sign_ = (word % 2 == 1 ? Sign::NEGATIVE : Sign::POSITIVE);
+    value.digits_.resize(limbs);
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data + SERIALIZED_HEADER);
+    for (size_t i = 0; i < limbs; ++i, in += 4) {
+        uint32_t limb = in[0] | (in[1] << 8) | (in[2] << 16) | (uint32_t(in[3]) << 24);
+        if (limb >= base) {
+            return 0;
+        }
+        value.digits_[i] = limb;
+    }
+    if (limbs > 1 && value.digits_.back() == 0) {
+        return 0;
+    }
+    if (value.digits_.back() == 0 && value.sign_ == Sign::NEGATIVE) {
+        return 0;
+    }
+    result = std::move(value);
+    return SERIALIZED_HEADER + 4 * limbs;
+}
+
+Montgomery::Montgomery(const BigInteger& modulus) : modulus_(modulus), m_(modulus.toBinary()) {
+    assert(modulus.getSign() == Sign::POSITIVE && (m_[0] & 1) == 1);
+    uint64_t inverse = 1;
+    for (int i = 0; i < 6; ++i) {
+        inverse *= 2 - m_[0] * inverse;
+    }
+    inverse_ = 0 - inverse;
+    Limbs r2(2 * m_.size() + 1, 0);
+    r2.back() = 1;
+    r2_ = limbs_divide(r2, m_);
+}
+
+const BigInteger& Montgomery::getModulus() const {
+    return modulus_;
+}
+
+// Coarsely integrated operand scanning: a*b*2^(-64n) mod m, with the
+// final subtraction done unconditionally and selected by mask.
+Montgomery::Limbs Montgomery::mul(const Limbs& a, const Limbs& b) const {
+    size_t n = m_.size();
+    Limbs t(n + 2, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; ++j) {
+            uint128_t cur = uint128_t(a[j]) * b[i] + t[j] + carry;
+            t[j] = static_cast<uint64_t>(cur);
+            carry = static_cast<uint64_t>(cur >> 64);
+        }
+        uint128_t top = uint128_t(t[n]) + carry;
+        t[n] = static_cast<uint64_t>(top);
+        t[n + 1] = static_cast<uint64_t>(top >> 64);
+        uint64_t u = t[0] * inverse_;
+        uint128_t cur = uint128_t(u) * m_[0] + t[0];
+        carry = static_cast<uint64_t>(cur >> 64);
+        for (size_t j = 1; j < n; ++j) {
+            cur = uint128_t(u) * m_[j] + t[j] + carry;
+            t[j - 1] = static_cast<uint64_t>(cur);
+            carry = static_cast<uint64_t>(cur >> 64);
+        }
+        top = uint128_t(t[n]) + carry;
+        t[n - 1] = static_cast<uint64_t>(top);
+        t[n] = t[n + 1] + static_cast<uint64_t>(top >> 64);
+    }
+    Limbs result(n);
+    uint64_t borrow = limbs_sub(result.data(), t.data(), m_.data(), n);
+    uint64_t keep = 0 - (borrow & (t[n] == 0 ? 1 : 0));
+    limbs_select(result.data(), t.data(), result.data(), n, keep);
+    return result;
+}
+
+BigInteger Montgomery::multiply(const BigInteger& a, const BigInteger& b) const {
+    Limbs x = limbs_reduce(a, m_, a.toBinary());
+    Limbs y = limbs_reduce(b, m_, b.toBinary());
+    return BigInteger::fromBinary(mul(mul(x, y), r2_));
+}
+
+BigInteger Montgomery::pow(const BigInteger& base, const BigInteger& exponent,
+                           bool constant_time) const {
+    assert(exponent.getSign() == Sign::POSITIVE);
+    Limbs unit(m_.size(), 0);
+    unit[0] = 1;
+    Limbs one = mul(unit, r2_);
+    Limbs x = mul(limbs_reduce(base, m_, base.toBinary()), r2_);
+    auto multiply = [this](const Limbs& a, const Limbs& b) { return mul(a, b); };
+    Limbs result = limbs_pow(multiply, x, one, exponent.toBinary(), constant_time);
+    return BigInteger::fromBinary(mul(result, unit));
+}
+
+Barrett::Barrett(const BigInteger& modulus) : modulus_(modulus), m_(modulus.toBinary()) {
+    assert(modulus.getSign() == Sign::POSITIVE && modulus != 0);
+    Limbs power(2 * m_.size() + 1, 0);
+    power.back() = 1;
+    limbs_divide(power, m_, &mu_);
+    mu_.resize(m_.size() + 2);
+}
+
+const BigInteger& Barrett::getModulus() const {
+    return modulus_;
+}
+
+// With x = a*b < b^(2k) and mu = floor(b^(2k) / m) (k + 2 limbs, for
+// when m is a power of b), q = floor(floor(x / b^(k-1)) * mu / b^(k+1))
+// is at most two below floor(x / m), so x - q*m needs at most two
+// corrective subtractions, both always performed and masked.
+Barrett::Limbs Barrett::mul(const Limbs& a, const Limbs& b) const {
+    size_t k = m_.size();
+    Limbs x = limbs_multiply(a.data(), k, b.data(), k);
+    Limbs q2 = limbs_multiply(x.data() + k - 1, k + 1, mu_.data(), mu_.size());
+    Limbs q3(q2.begin() + k + 1, q2.begin() + 2 * k + 2);
+    Limbs qm = limbs_multiply(q3.data(), k + 1, m_.data(), k);
+    Limbs r(k + 1);
+    limbs_sub(r.data(), x.data(), qm.data(), k + 1);
+    Limbs wide_m(m_);
+    wide_m.push_back(0);
+    Limbs reduced(k + 1);
+    for (int i = 0; i < 2; ++i) {
+        uint64_t borrow = limbs_sub(reduced.data(), r.data(), wide_m.data(), k + 1);
+        limbs_select(r.data(), r.data(), reduced.data(), k + 1, 0 - borrow);
+    }
+    r.pop_back();
+    return r;
+}
+
+BigInteger Barrett::multiply(const BigInteger& a, const BigInteger& b) const {
+    Limbs x = limbs_reduce(a, m_, a.toBinary());
+    Limbs y = limbs_reduce(b, m_, b.toBinary());
+    return BigInteger::fromBinary(mul(x, y));
+}
+
+BigInteger Barrett::pow(const BigInteger& base, const BigInteger& exponent,
+                        bool constant_time) const {
+    assert(exponent.getSign() == Sign::POSITIVE);
+    Limbs one(m_.size(), 0);
+    one[0] = 1;
+    one = limbs_divide(one, m_);
+    Limbs x = limbs_reduce(base, m_, base.toBinary());
+    auto multiply = [this](const Limbs& a, const Limbs& b) { return mul(a, b); };
+    return BigInteger::fromBinary(limbs_pow(multiply, x, one, exponent.toBinary(), constant_time));
+}
+
+BigInteger powmod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus,
+                  bool constant_time) {
+    if (modulus.digits_[0] % 2 == 1) {
+        return Montgomery(modulus).pow(base, exponent, constant_time);
+    }
+    return Barrett(modulus).pow(base, exponent, constant_time);
+}
+
+BigInteger pow(const BigInteger& base, uint64_t exponent) {
+    BigInteger result = 1;
+    BigInteger square = base;
+    while (exponent > 0) {
+        if (exponent % 2 == 1) {
+            result *= square;
+        }
+        exponent /= 2;
+        if (exponent > 0) {
+            square *= square;
+        }
+    }
+    return result;
+}
+
+BigInteger isqrt(const BigInteger& n) {
+    return iroot(n, 2);
+}
+
+// Integer Newton iteration x = ((k - 1) * x + n / x^(k - 1)) / k decreases
+// monotonically to the root from any upper bound and never undershoots
+// it. The bound comes from the root of n's top half (shifted back), or
+// from floating point once the root fits in two limbs, so usually a
+// single step per level is needed.
+BigInteger iroot(const BigInteger& n, uint64_t k) {
+    assert(k > 0 && (n.sign_ == Sign::POSITIVE || k % 2 == 1));
+    if (n.sign_ == Sign::NEGATIVE) {
+        BigInteger magnitude = n;
+        magnitude.invert();
+        BigInteger root = iroot(magnitude, k);
+        root.invert();
+        return root;
+    }
+    if (k == 1 || (n.digits_.size() == 1 && n.digits_[0] <= 1)) {
+        return n;
+    }
+    // n < 2^k, so the root is below 2.
+    if (k >= n.bitLength()) {
+        return 1;
+    }
+    size_t limbs = n.digits_.size();
+    size_t high = limbs / k / 2;
+    BigInteger x;
+    if (high == 0) {
+        double top = static_cast<double>(n.digits_[limbs - 1]);
+        if (limbs > 1) {
+            top += static_cast<double>(n.digits_[limbs - 2]) / BigInteger::base;
+        }
+        double exponent = (std::log10(top) + 9.0 * static_cast<double>(limbs - 1)) / k;
+        x = static_cast<int64_t>(std::pow(10.0, exponent) * (1 + 1e-9)) + 2;
+        while (pow(x, k) < n) {
+            x *= 2;
+        }
+    } else {
+        int64_t shift = static_cast<int64_t>(high);
+        BigInteger root = iroot(BigInteger::shiftLimbs(n, -shift * static_cast<int64_t>(k)), k);
+        x = BigInteger::shiftLimbs(root + 1, shift);
+    }
+    BigInteger degree = static_cast<int64_t>(k);
+    while (true) {
+        BigInteger next = (x * (degree - 1) + n / pow(x, k - 1)) / degree;
+        if (!(next < x)) {
+            return x;
+        }
+        BigInteger step = x - next;
+        x = next;
+        // Convergence is quadratic: after a step this small x is within a
+        // unit or so of the root, which is cheaper to fix than to divide.
+        if (step * step * degree <= x) {
+            break;
+        }
+    }
+    while (pow(x, k) > n) {
+        x -= 1;
+    }
+    return x;
+}
+
+BigInteger factorial(uint64_t n) {
+    std::vector<uint64_t> words;
+    for (uint64_t i = 2; i <= n; ++i) {
+        decimal_pack(words, i);
+    }
+    return decimal_product(words, 0, words.size());
+}
+
+// For k below n / 1024, or n too large to sieve, C(n, k) is the
+// falling product (n - k + 1) ... n divided by k!. Otherwise it is built
+// from its prime factorization by Kummer: the exponent of a prime p in
+// C(n, k) is the sum over powers q of p of
+// floor(n / q) - floor(k / q) - floor((n - k) / q).
+BigInteger binomial(uint64_t n, uint64_t k) {
+    const uint64_t SIEVE_LIMIT = 1 << 26;
+    if (k > n) {
+        return 0;
+    }
+    k = std::min(k, n - k);
+    if (n > SIEVE_LIMIT || k < n / 1024) {
+        std::vector<uint64_t> words;
+        for (uint64_t i = 0; i < k; ++i) {
+            decimal_pack(words, n - i);
+        }
+        return decimal_product(words, 0, words.size()) / factorial(k);
+    }
+    std::vector<bool> composite(n + 1, false);
+    std::vector<uint64_t> words;
+    for (uint64_t p = 2; p <= n; ++p) {
+        if (composite[p]) {
+            continue;
+        }
+        if (p <= n / p) {
+            for (uint64_t multiple = p * p; multiple <= n; multiple += p) {
+                composite[multiple] = true;
+            }
+        }
+        uint64_t power = p;
+        while (true) {
+            uint64_t count = n / power - k / power - (n - k) / power;
+            for (uint64_t i = 0; i < count; ++i) {
+                decimal_pack(words, p);
+            }
+            if (power > n / p) {
+                break;
+            }
+            power *= p;
+        }
+    }
+    return decimal_product(words, 0, words.size());
+}
+
 Rational::Rational(const BigInteger& n) : numerator_(n), denominator_(1){};
 
 Rational Rational::operator-() {
@@ -409,6 +1705,11 @@ Rational& Rational::operator-=(const Rational& other) {
     return *this;
 }
 
+size_t Rational::hash() const {
+    size_t seed = numerator_.hash();
+    return seed ^ (denominator_.hash() + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
 void Rational::normalize() {
     if (denominator_.getSign() == Sign::NEGATIVE) {
         denominator_.invert();
@@ -519,3 +1820,248 @@ BigInteger Rational::pow(int a, size_t b) {
     }
     return ans;
 }
+
+Decimal::Decimal(int64_t n) : coefficient_(n) {}
+
+Decimal::Decimal(const BigInteger& n) : coefficient_(n) {}
+
+Decimal::Decimal(const BigInteger& coefficient, size_t scale)
+    : coefficient_(coefficient), scale_(scale) {}
+
+Decimal::Decimal(const char* str, size_t size) {
+    const char* point = std::find(str, str + size, '.');
+    if (point == str + size) {
+        coefficient_ = BigInteger(str, size);
+        return;
+    }
+    std::string digits(str, point);
+    digits.append(point + 1, str + size);
+    coefficient_ = BigInteger(digits);
+    scale_ = static_cast<size_t>(str + size - point - 1);
+}
+
+Decimal::Decimal(const std::string& str) : Decimal(str.data(), str.size()) {}
+
+BigInteger Decimal::scaleUp(const BigInteger& x, size_t digits) {
+    BigInteger result = BigInteger::shiftLimbs(x, static_cast<int64_t>(digits / BigInteger::len));
+    if (digits % BigInteger::len != 0) {
+        result *= DECIMAL_POWERS[digits % BigInteger::len];
+    }
+    return result;
+}
+
+BigInteger Decimal::scaleDown(const BigInteger& x, size_t digits) {
+    BigInteger result = BigInteger::shiftLimbs(x, -static_cast<int64_t>(digits / BigInteger::len));
+    if (digits % BigInteger::len != 0) {
+        result /= DECIMAL_POWERS[digits % BigInteger::len];
+    }
+    return result;
+}
+
+Decimal Decimal::operator-() const {
+    Decimal result = *this;
+    if (result.coefficient_) {
+        result.coefficient_.invert();
+    }
+    return result;
+}
+
+Decimal& Decimal::operator+=(const Decimal& other) {
+    if (other.scale_ > scale_) {
+        setScale(other.scale_);
+    }
+    if (other.scale_ == scale_) {
+        coefficient_ += other.coefficient_;
+    } else {
+        coefficient_ += scaleUp(other.coefficient_, scale_ - other.scale_);
+    }
+    return *this;
+}
+
+Decimal& Decimal::operator-=(const Decimal& other) {
+    if (other.scale_ > scale_) {
+        setScale(other.scale_);
+    }
+    if (other.scale_ == scale_) {
+        coefficient_ -= other.coefficient_;
+    } else {
+        coefficient_ -= scaleUp(other.coefficient_, scale_ - other.scale_);
+    }
+    return *this;
+}
+
+Decimal& Decimal::operator*=(const Decimal& other) {
+    coefficient_ *= other.coefficient_;
+    scale_ += other.scale_;
+    return *this;
+}
+
+const BigInteger& Decimal::getCoefficient() const {
+    return coefficient_;
+}
+
+size_t Decimal::getScale() const {
+    return scale_;
+}
+
+void Decimal::setScale(size_t scale) {
+    if (scale > scale_) {
+        coefficient_ = scaleUp(coefficient_, scale - scale_);
+    } else if (scale < scale_) {
+        coefficient_ = scaleDown(coefficient_, scale_ - scale);
+    }
+    scale_ = scale;
+}
+
+void Decimal::normalize() {
+    const std::vector<int64_t>& digits = coefficient_.digits_;
+    if (digits.back() == 0) {
+        scale_ = 0;
+        return;
+    }
+    size_t zeros = 0;
+    size_t i = 0;
+    while (digits[i] == 0 && zeros + BigInteger::len <= scale_) {
+        zeros += BigInteger::len;
+        ++i;
+    }
+    for (int64_t limb = digits[i]; limb % 10 == 0 && zeros < scale_; limb /= 10) {
+        ++zeros;
+    }
+    setScale(scale_ - zeros);
+}
+
+Sign Decimal::getSign() const {
+    return coefficient_.getSign();
+}
+
+std::string Decimal::toString() const {
+    std::string result = coefficient_.toString();
+    if (scale_ == 0) {
+        return result;
+    }
+    size_t sign = (coefficient_.getSign() == Sign::NEGATIVE ? 1 : 0);
+    if (result.size() - sign <= scale_) {
+        result.insert(sign, scale_ + 1 - (result.size() - sign), '0');
+    }
+    result.insert(result.size() - scale_, 1, '.');
+    return result;
+}
+
+Rational Decimal::toRational() const {
+    Rational result;
+    result.numerator_ = coefficient_;
+    result.denominator_ = scaleUp(1, scale_);
+    result.normalize();
+    return result;
+}
+
+bool Decimal::fromRational(const Rational& rational, Decimal& result) {
+    BigInteger rest = rational.denominator_;
+    size_t twos = 0;
+    size_t fives = 0;
+    while (rest % 10 == 0) {
+        rest /= 10;
+        ++twos;
+        ++fives;
+    }
+    while (rest % 2 == 0) {
+        rest /= 2;
+        ++twos;
+    }
+    while (rest % 5 == 0) {
+        rest /= 5;
+        ++fives;
+    }
+    if (rest != 1) {
+        return false;
+    }
+    size_t scale = std::max(twos, fives);
+    BigInteger factor = (twos < fives ? pow(BigInteger(2), scale - twos)
+                                      : pow(BigInteger(5), scale - fives));
+    result = Decimal(rational.numerator_ * factor, scale);
+    return true;
+}
+
+Decimal Decimal::divide(const Decimal& a, const Decimal& b, size_t scale) {
+    // a / b = (a.coefficient_ / b.coefficient_) * 10^(b.scale_ - a.scale_).
+    size_t up = scale + b.scale_;
+    if (up >= a.scale_) {
+        return Decimal(scaleUp(a.coefficient_, up - a.scale_) / b.coefficient_, scale);
+    }
+    return Decimal(a.coefficient_ / scaleUp(b.coefficient_, a.scale_ - up), scale);
+}
+
+size_t Decimal::hash() const {
+    if (scale_ != 0 && coefficient_.digits_[0] % 10 == 0) {
+        Decimal reduced = *this;
+        reduced.normalize();
+        if (reduced.scale_ != scale_) {
+            return reduced.hash();
+        }
+    }
+    size_t seed = coefficient_.hash();
+    return seed ^ (scale_ + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+std::ostream& operator<<(std::ostream& out, const Decimal& decimal) {
+    out << decimal.toString();
+    return out;
+}
+
+Decimal operator""_dec(const char* str, size_t size) {
+    return Decimal(str, size);
+}
+
+Decimal operator+(Decimal a, const Decimal& b) {
+    a += b;
+    return a;
+}
+
+Decimal operator-(Decimal a, const Decimal& b) {
+    a -= b;
+    return a;
+}
+
+Decimal operator*(Decimal a, const Decimal& b) {
+    a *= b;
+    return a;
+}
+
+int Decimal::compare(const Decimal& a, const Decimal& b) {
+    if (a.getSign() != b.getSign()) {
+        return a.getSign() == Sign::NEGATIVE ? -1 : 1;
+    }
+    if (a.scale_ == b.scale_) {
+        return a.coefficient_ < b.coefficient_ ? -1 : (b.coefficient_ < a.coefficient_ ? 1 : 0);
+    }
+    if (a.scale_ < b.scale_) {
+        return -compare(b, a);
+    }
+    BigInteger scaled = scaleUp(b.coefficient_, a.scale_ - b.scale_);
+    return a.coefficient_ < scaled ? -1 : (scaled < a.coefficient_ ? 1 : 0);
+}
+
+bool operator<(const Decimal& a, const Decimal& b) {
+    return Decimal::compare(a, b) < 0;
+}
+
+bool operator>(const Decimal& a, const Decimal& b) {
+    return b < a;
+}
+
+bool operator<=(const Decimal& a, const Decimal& b) {
+    return !(a > b);
+}
+
+bool operator>=(const Decimal& a, const Decimal& b) {
+    return !(a < b);
+}
+
+bool operator==(const Decimal& a, const Decimal& b) {
+    return Decimal::compare(a, b) == 0;
+}
+
+bool operator!=(const Decimal& a, const Decimal& b) {
+    return !(a == b);
+}
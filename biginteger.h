@@ -1,127 +1,360 @@
-#include <algorithm>
-#include <cassert>
-#include <string>
-#include <vector>
-
-enum class Sign { POSITIVE, NEGATIVE };
-
-class BigInteger {
-    friend bool operator<(const BigInteger& a, const BigInteger& b);
-    friend bool operator==(const BigInteger& a, const BigInteger& b);
-
-  private:
-    static Sign signum(int64_t x);
-    bool isPositive() const;
-    void clearZeros();
-    static void clearZeros(std::vector<int64_t>& v);
-    void multiplyBase();
-    static Sign getSignForMultiply(const BigInteger& a, const BigInteger& b);
-    std::pair<BigInteger, BigInteger> division(const BigInteger& other);
-    BigInteger& decreaseForPositive(const std::vector<int64_t>& my_digits,
-                                    const std::vector<int64_t>& other_digits);
-    BigInteger& increaseForPositive(const std::vector<int64_t>& other_digits);
-    BigInteger& decrease(const std::vector<int64_t>& other_digits);
-
-    static const int64_t base = 1e9;
-    static const int len = 9;
-    std::vector<int64_t> digits_;
-    Sign sign_ = Sign::POSITIVE;
-
-  public:
-    BigInteger() = default;
-    BigInteger(int64_t n);
-    BigInteger(const std::string& str, size_t size);
-    explicit BigInteger(const std::string& str);
-    std::string toString() const;
-    BigInteger& operator+=(const BigInteger& other);
-    BigInteger& operator*=(const BigInteger& other);
-    BigInteger& operator/=(const BigInteger& other);
-    BigInteger& operator%=(const BigInteger& other);
-    BigInteger& operator-=(const BigInteger& other);
-    BigInteger operator-();
-    BigInteger& operator++();
-    BigInteger operator++(int);
-    explicit operator bool() const;
-    void invert();
-    Sign getSign() const;
-};
-
-std::ostream& operator<<(std::ostream& out, const BigInteger& big_integer);
-
-BigInteger operator""_bi(const char* str, size_t size);
-
-BigInteger operator""_bi(unsigned long long n);
-
-BigInteger operator+(BigInteger a, const BigInteger& b);
-
-BigInteger operator-(BigInteger a, const BigInteger& b);
-
-BigInteger operator*(BigInteger a, const BigInteger& b);
-
-BigInteger operator/(BigInteger a, const BigInteger& b);
-
-BigInteger operator%(BigInteger a, const BigInteger& b);
-
-bool operator<(const BigInteger& a, const BigInteger& b);
-
-bool comparePositive(const std::vector<int64_t>& a,
-                     const std::vector<int64_t>& b, bool strictly = true);
-
-bool operator>(const BigInteger& a, const BigInteger& b);
-
-bool operator<=(const BigInteger& a, const BigInteger& b);
-
-bool operator>=(const BigInteger& a, const BigInteger& b);
-
-bool operator==(const BigInteger& a, const BigInteger& b);
-
-bool operator!=(const BigInteger& a, const BigInteger& b);
-
-std::istream& operator>>(std::istream& in, BigInteger& big_integer);
-
-class Rational {
-    friend bool operator<(const Rational& a, const Rational& b);
-    friend bool operator==(const Rational& a, const Rational& b);
-
-  private:
-    static BigInteger gcd(BigInteger a, BigInteger b);
-    static BigInteger pow(int a, size_t b);
-    void normalize();
-
-    BigInteger numerator_;
-    BigInteger denominator_;
-
-  public:
-    Rational(const BigInteger& n);
-    Rational(int n);
-    Rational() = default;
-    Rational operator-();
-    Rational& operator+=(const Rational& other);
-    Rational& operator*=(const Rational& other);
-    Rational& operator/=(const Rational& other);
-    Rational& operator-=(const Rational& other);
-    std::string toString() const;
-    Sign getSign() const;
-    std::string asDecimal(size_t precision) const;
-    explicit operator double() const;
-};
-
-Rational operator+(Rational a, const Rational& b);
-
-Rational operator-(Rational a, const Rational& b);
-
-Rational operator/(Rational a, const Rational& b);
-
-Rational operator*(Rational a, const Rational& b);
-
-bool operator<(const Rational& a, const Rational& b);
-
-bool operator>(const Rational& a, const Rational& b);
-
-bool operator<=(const Rational& a, const Rational& b);
-
-bool operator>=(const Rational& a, const Rational& b);
-
-bool operator==(const Rational& a, const Rational& b);
-
-bool operator!=(const Rational& a, const Rational& b);
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class Sign { POSITIVE, NEGATIVE };
+
+class BigInteger {
+    friend bool operator<(const BigInteger& a, const BigInteger& b);
+    friend bool operator==(const BigInteger& a, const BigInteger& b);
+    friend class Montgomery;
+    friend class Barrett;
+    friend class BigIntegerColumn;
+    friend class Decimal;
+    template <size_t>
+    friend class FixedBigInteger;
+    friend BigInteger powmod(const BigInteger& base, const BigInteger& exponent,
+                             const BigInteger& modulus, bool constant_time);
+    friend BigInteger iroot(const BigInteger& n, uint64_t k);
+    friend std::istream& operator>>(std::istream& in, BigInteger& big_integer);
+
+  private:
+    static Sign signum(int64_t x);
+    bool isPositive() const;
+    void clearZeros();
+    static void clearZeros(std::vector<int64_t>& v);
+    void multiplyBase();
+    static Sign getSignForMultiply(const BigInteger& a, const BigInteger& b);
+    std::pair<BigInteger, BigInteger> division(const BigInteger& other);
+    BigInteger& decreaseForPositive(const std::vector<int64_t>& my_digits,
+                                    const std::vector<int64_t>& other_digits);
+    BigInteger& increaseForPositive(const std::vector<int64_t>& other_digits);
+    BigInteger& decrease(const std::vector<int64_t>& other_digits);
+    // Magnitude as little-endian base 2^64 limbs, and back. Long values
+    // are split at powers[k] = 2^(64 * 2^k), kept in decimal, so that the
+    // work goes to the fast multiplication and division.
+    std::vector<uint64_t> toBinary() const;
+    static BigInteger fromBinary(std::vector<uint64_t> limbs);
+    static std::vector<BigInteger> binaryPowers(size_t limbs);
+    static void toBinary(const BigInteger& x, const std::vector<BigInteger>& powers,
+                         const std::vector<BigInteger>& reciprocals, uint64_t* out, size_t size);
+    static BigInteger fromBinary(const uint64_t* limbs, size_t size,
+                                 const std::vector<BigInteger>& powers);
+    static BigInteger shiftLimbs(const BigInteger& x, int64_t limbs);
+    static BigInteger reciprocal(const BigInteger& v);
+    static std::pair<BigInteger, BigInteger> divideNewton(const BigInteger& a,
+                                                          const BigInteger& b);
+    static BigInteger bitwise(const BigInteger& a, const BigInteger& b, char op);
+
+    static const int64_t base = 1e9;
+    static const int len = 9;
+    std::vector<int64_t> digits_;
+    Sign sign_ = Sign::POSITIVE;
+
+  public:
+    BigInteger() = default;
+    BigInteger(int64_t n);
+    BigInteger(const char* str, size_t size);
+    BigInteger(const std::string& str, size_t size);
+    explicit BigInteger(const std::string& str);
+    std::string toString() const;
+    BigInteger& operator+=(const BigInteger& other);
+    BigInteger& operator*=(const BigInteger& other);
+    BigInteger& operator/=(const BigInteger& other);
+    BigInteger& operator%=(const BigInteger& other);
+    BigInteger& operator-=(const BigInteger& other);
+    BigInteger operator-();
+    BigInteger& operator++();
+    BigInteger operator++(int);
+    // Bitwise operators act on the infinite two's complement form, as
+    // with the built-in integers; they go through a binary conversion
+    // that costs O(M(n) log n) for an n-limb multiplication time M(n).
+    // Shifts are multiplications and floor divisions by powers of two.
+    BigInteger& operator&=(const BigInteger& other);
+    BigInteger& operator|=(const BigInteger& other);
+    BigInteger& operator^=(const BigInteger& other);
+    BigInteger& operator<<=(uint64_t shift);
+    BigInteger& operator>>=(uint64_t shift);
+    BigInteger operator~() const;
+    // Of the magnitude.
+    uint64_t popcount() const;
+    uint64_t bitLength() const;
+    explicit operator bool() const;
+    void invert();
+    Sign getSign() const;
+    size_t hash() const;
+    // Binary form: a little-endian 64-bit word holding twice the limb
+    // count plus 1 if negative, then the base 10^9 limbs, least
+    // significant first, as little-endian 32-bit words. Being the
+    // in-memory representation, it needs no radix conversion either way.
+    static const size_t SERIALIZED_HEADER = 8;
+    size_t serializedSize() const;
+    // Size of the whole record starting with this header.
+    static size_t serializedSize(const char* header);
+    size_t serialize(char* out) const;
+    // Returns the number of bytes consumed, or 0 if the data is truncated
+    // or malformed, in which case result is left unchanged.
+    static size_t deserialize(const char* data, size_t size, BigInteger& result);
+    // Multiplication, division and conversion of operands with at least
+    // `limbs` limbs (9 decimal digits each) split work over a shared pool
+    // of `threads` threads; 1 turns this off. Neither may be called while
+    // other threads are doing BigInteger arithmetic.
+    static void setThreadCount(size_t threads);
+    static void setParallelThreshold(size_t limbs);
+};
+
+std::ostream& operator<<(std::ostream& out, const BigInteger& big_integer);
+
+BigInteger operator""_bi(const char* str, size_t size);
+
+BigInteger operator""_bi(unsigned long long n);
+
+BigInteger operator+(BigInteger a, const BigInteger& b);
+
+BigInteger operator-(BigInteger a, const BigInteger& b);
+
+BigInteger operator*(BigInteger a, const BigInteger& b);
+
+BigInteger operator/(BigInteger a, const BigInteger& b);
+
+BigInteger operator%(BigInteger a, const BigInteger& b);
+
+BigInteger operator&(BigInteger a, const BigInteger& b);
+
+BigInteger operator|(BigInteger a, const BigInteger& b);
+
+BigInteger operator^(BigInteger a, const BigInteger& b);
+
+BigInteger operator<<(BigInteger a, uint64_t shift);
+
+BigInteger operator>>(BigInteger a, uint64_t shift);
+
+bool operator<(const BigInteger& a, const BigInteger& b);
+
+bool comparePositive(const std::vector<int64_t>& a,
+                     const std::vector<int64_t>& b, bool strictly = true);
+
+bool operator>(const BigInteger& a, const BigInteger& b);
+
+bool operator<=(const BigInteger& a, const BigInteger& b);
+
+bool operator>=(const BigInteger& a, const BigInteger& b);
+
+bool operator==(const BigInteger& a, const BigInteger& b);
+
+bool operator!=(const BigInteger& a, const BigInteger& b);
+
+std::istream& operator>>(std::istream& in, BigInteger& big_integer);
+
+// Modular arithmetic for a fixed odd modulus. Operands are kept in
+// binary Montgomery form internally, so a modular multiplication costs
+// two limb products and no division.
+class Montgomery {
+  public:
+    explicit Montgomery(const BigInteger& modulus);
+    const BigInteger& getModulus() const;
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const;
+    // With `constant_time`, the sequence of operations and the table
+    // entries touched do not depend on the exponent's bits.
+    BigInteger pow(const BigInteger& base, const BigInteger& exponent,
+                   bool constant_time = false) const;
+
+  private:
+    using Limbs = std::vector<uint64_t>;
+
+    Limbs mul(const Limbs& a, const Limbs& b) const;
+
+    BigInteger modulus_;
+    Limbs m_;
+    uint64_t inverse_;
+    Limbs r2_;
+};
+
+// The same interface for any modulus > 0, including the even ones
+// Montgomery cannot handle, using Barrett reduction.
+class Barrett {
+  public:
+    explicit Barrett(const BigInteger& modulus);
+    const BigInteger& getModulus() const;
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const;
+    BigInteger pow(const BigInteger& base, const BigInteger& exponent,
+                   bool constant_time = false) const;
+
+  private:
+    using Limbs = std::vector<uint64_t>;
+
+    Limbs mul(const Limbs& a, const Limbs& b) const;
+
+    BigInteger modulus_;
+    Limbs m_;
+    Limbs mu_;
+};
+
+// base^exponent mod modulus for exponent >= 0 and modulus > 0; the result
+// is in [0, modulus). Odd moduli go through Montgomery, even ones Barrett.
+BigInteger powmod(const BigInteger& base, const BigInteger& exponent, const BigInteger& modulus,
+                  bool constant_time = false);
+
+BigInteger pow(const BigInteger& base, uint64_t exponent);
+
+// floor(sqrt(n)) and floor(n^(1/k)) for n >= 0; iroot also takes a
+// negative n for odd k and rounds toward zero.
+BigInteger isqrt(const BigInteger& n);
+
+BigInteger iroot(const BigInteger& n, uint64_t k);
+
+// n! and C(n, k), multiplied out as balanced product trees so that most
+// of the work is in a few large (Karatsuba/NTT) products. C(n, k) is the
+// falling product over k! when k is small next to n or n is above 2^26,
+// and otherwise is built from its prime factorization with an n-bit sieve.
+BigInteger factorial(uint64_t n);
+
+BigInteger binomial(uint64_t n, uint64_t k);
+
+class Rational {
+    friend bool operator<(const Rational& a, const Rational& b);
+    friend bool operator==(const Rational& a, const Rational& b);
+    friend class Decimal;
+
+  private:
+    static BigInteger gcd(BigInteger a, BigInteger b);
+    static BigInteger pow(int a, size_t b);
+    void normalize();
+
+    BigInteger numerator_;
+    BigInteger denominator_;
+
+  public:
+    Rational(const BigInteger& n);
+    Rational(int n);
+    Rational() = default;
+    Rational operator-();
+    Rational& operator+=(const Rational& other);
+    Rational& operator*=(const Rational& other);
+    Rational& operator/=(const Rational& other);
+    Rational& operator-=(const Rational& other);
+    std::string toString() const;
+    Sign getSign() const;
+    std::string asDecimal(size_t precision) const;
+    explicit operator double() const;
+    // Of the normalized numerator and denominator.
+    size_t hash() const;
+};
+
+Rational operator+(Rational a, const Rational& b);
+
+Rational operator-(Rational a, const Rational& b);
+
+Rational operator/(Rational a, const Rational& b);
+
+Rational operator*(Rational a, const Rational& b);
+
+bool operator<(const Rational& a, const Rational& b);
+
+bool operator>(const Rational& a, const Rational& b);
+
+bool operator<=(const Rational& a, const Rational& b);
+
+bool operator>=(const Rational& a, const Rational& b);
+
+bool operator==(const Rational& a, const Rational& b);
+
+bool operator!=(const Rational& a, const Rational& b);
+
+// The decimal fraction coefficient / 10^scale, e.g. an amount of money.
+// Sums, differences, products and comparisons only rescale by powers of
+// ten, which is a limb shift and a one-limb product, and never take a
+// gcd as Rational does. A sum keeps the larger scale of its operands and
+// a product their total, so 1.50 + 2.5 is 4.00. Quotients need not be
+// decimal: divide() rounds them to a given scale, and toRational() and
+// fromRational() switch to and from exact fractions where needed.
+class Decimal {
+    friend bool operator<(const Decimal& a, const Decimal& b);
+    friend bool operator==(const Decimal& a, const Decimal& b);
+
+  private:
+    // x * 10^digits, and x / 10^digits rounded toward zero.
+    static BigInteger scaleUp(const BigInteger& x, size_t digits);
+    static BigInteger scaleDown(const BigInteger& x, size_t digits);
+    static int compare(const Decimal& a, const Decimal& b);
+
+    BigInteger coefficient_ = 0;
+    size_t scale_ = 0;
+
+  public:
+    Decimal() = default;
+    Decimal(int64_t n);
+    Decimal(const BigInteger& n);
+    Decimal(const BigInteger& coefficient, size_t scale);
+    // An optional sign, digits and an optional fractional part, as in
+    // "-12.50"; the scale is the number of digits after the point.
+    Decimal(const char* str, size_t size);
+    explicit Decimal(const std::string& str);
+    Decimal operator-() const;
+    Decimal& operator+=(const Decimal& other);
+    Decimal& operator-=(const Decimal& other);
+    Decimal& operator*=(const Decimal& other);
+    const BigInteger& getCoefficient() const;
+    size_t getScale() const;
+    // Rounds toward zero when the scale goes down.
+    void setScale(size_t scale);
+    // Drops trailing zeros after the point.
+    void normalize();
+    Sign getSign() const;
+    std::string toString() const;
+    Rational toRational() const;
+    // Fails, leaving result unchanged, unless the reduced denominator
+    // divides a power of ten.
+    static bool fromRational(const Rational& rational, Decimal& result);
+    // a / b rounded toward zero to `scale` digits after the point.
+    static Decimal divide(const Decimal& a, const Decimal& b, size_t scale);
+    // Equal values hash alike whatever their scale.
+    size_t hash() const;
+};
+
+std::ostream& operator<<(std::ostream& out, const Decimal& decimal);
+
+Decimal operator""_dec(const char* str, size_t size);
+
+Decimal operator+(Decimal a, const Decimal& b);
+
+Decimal operator-(Decimal a, const Decimal& b);
+
+Decimal operator*(Decimal a, const Decimal& b);
+
+bool operator<(const Decimal& a, const Decimal& b);
+
+bool operator>(const Decimal& a, const Decimal& b);
+
+bool operator<=(const Decimal& a, const Decimal& b);
+
+bool operator>=(const Decimal& a, const Decimal& b);
+
+bool operator==(const Decimal& a, const Decimal& b);
+
+bool operator!=(const Decimal& a, const Decimal& b);
+
+template <>
+struct std::hash<BigInteger> {
+    size_t operator()(const BigInteger& big_integer) const {
+        return big_integer.hash();
+    }
+};
+
+template <>
+struct std::hash<Rational> {
+    size_t operator()(const Rational& rational) const {
+        return rational.hash();
+    }
+};
+
+template <>
+struct std::hash<Decimal> {
+    size_t operator()(const Decimal& decimal) const {
+        return decimal.hash();
+    }
+};
@@ -0,0 +1,279 @@
+#include "biginteger_batch.h"
+#include <algorithm>
+#include <cassert>
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+#define BATCH_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define BATCH_KERNEL
+#endif
+
+namespace {
+
+const size_t BATCH_LANES = BigIntegerColumn::LANES;
+const int32_t BATCH_BASE = 1000000000;
+const size_t BATCH_GRAIN = 16;
+// Sixteen products below 10^18, plus carries, still fit in a uint64_t.
+const size_t BATCH_CARRY_ROWS = 16;
+
+// x / 10^9 for any 64-bit x, as (x / 2^9) / 1953125 by multiplying with
+// a fixed-point reciprocal. Built from 32 x 32 -> 64 bit products only,
+// so that loops over it vectorize, unlike a 64-bit division.
+inline uint64_t batch_divide_base(uint64_t x) {
+    const uint64_t magic_low = 0xa09b5a53;
+    const uint64_t magic_high = 0x44b82f;
+    uint64_t n = x >> 9;
+    uint64_t n_low = n & 0xffffffff;
+    uint64_t n_high = n >> 32;
+    uint64_t low = n_low * magic_low;
+    uint64_t middle = n_high * magic_low + (low >> 32);
+    uint64_t cross = n_low * magic_high + (middle & 0xffffffff);
+    uint64_t high = n_high * magic_high + (middle >> 32) + (cross >> 32);
+    return high >> 11;
+}
+
+// One block of lanes of a column: limb j of lane i is rows[j * stride + i].
+struct BatchBlock {
+    const uint32_t* rows;
+    size_t limbs;
+    const uint8_t* negative;
+};
+
+// out = a + b, or a - b with `subtract`, on one block of lanes, with
+// out.limbs = max(a.limbs, b.limbs) + 1. Each lane adds or subtracts the
+// magnitudes depending on the signs; a lane that goes below zero comes
+// out in ten's complement and is negated in a second pass.
+BATCH_KERNEL void batch_add_block(BatchBlock a, BatchBlock b, bool subtract, size_t stride,
+                                  uint32_t* out, size_t out_limbs, uint8_t* out_negative) {
+    static const uint32_t zeros[BATCH_LANES] = {};
+    int32_t flip[BATCH_LANES];
+    int32_t carry[BATCH_LANES] = {};
+    uint32_t nonzero[BATCH_LANES] = {};
+    for (size_t i = 0; i < BATCH_LANES; ++i) {
+        flip[i] = ((a.negative[i] != b.negative[i]) != subtract ? -1 : 0);
+    }
+    for (size_t j = 0; j < out_limbs; ++j) {
+        const uint32_t* x = (j < a.limbs ? a.rows + j * stride : zeros);
+        const uint32_t* y = (j < b.limbs ? b.rows + j * stride : zeros);
+        // Summed into a local row first, so that the loop provably does
+        // not write to its inputs and vectorizes without alias checks.
+        uint32_t sum[BATCH_LANES];
+        for (size_t i = 0; i < BATCH_LANES; ++i) {
+            int32_t addend = (static_cast<int32_t>(y[i]) ^ flip[i]) - flip[i];
+            int32_t t = static_cast<int32_t>(x[i]) + addend + carry[i];
+            int32_t over = (t >= BATCH_BASE ? 1 : 0);
+            int32_t under = (t < 0 ? 1 : 0);
+            carry[i] = over - under;
+            t += (under - over) * BATCH_BASE;
+            sum[i] = static_cast<uint32_t>(t);
+            nonzero[i] |= sum[i];
+        }
+        std::copy(sum, sum + BATCH_LANES, out + j * stride);
+    }
+    bool any_negative = false;
+    for (size_t i = 0; i < BATCH_LANES; ++i) {
+        any_negative |= (carry[i] < 0);
+    }
+    if (any_negative) {
+        int32_t borrow[BATCH_LANES] = {};
+        for (size_t j = 0; j < out_limbs; ++j) {
+            uint32_t* o = out + j * stride;
+            for (size_t i = 0; i < BATCH_LANES; ++i) {
+                int32_t t = -static_cast<int32_t>(o[i]) - borrow[i];
+                int32_t under = (t < 0 ? 1 : 0);
+                t += under * BATCH_BASE;
+                bool negate = (carry[i] < 0);
+                o[i] = (negate ? static_cast<uint32_t>(t) : o[i]);
+                borrow[i] = (negate ? under : 0);
+            }
+        }
+    }
+    for (size_t i = 0; i < BATCH_LANES; ++i) {
+        bool negative = (a.negative[i] != 0) != (carry[i] < 0);
+        out_negative[i] = (negative && nonzero[i] != 0 ? 1 : 0);
+    }
+}
+
+// Schoolbook products of one block of lanes into 64-bit accumulator rows
+// (`acc` has a.limbs + b.limbs + 1 rows of LANES), carried every
+// BATCH_CARRY_ROWS rows of a.
+BATCH_KERNEL void batch_multiply_block(BatchBlock a, BatchBlock b, size_t stride, uint32_t* out,
+                                       uint8_t* out_negative, uint64_t* acc) {
+    size_t out_limbs = a.limbs + b.limbs;
+    std::fill(acc, acc + (out_limbs + 1) * BATCH_LANES, 0);
+    size_t first = 0;
+    for (size_t j = 0; j < a.limbs; ++j) {
+        const uint32_t* x = a.rows + j * stride;
+        for (size_t k = 0; k < b.limbs; ++k) {
+            const uint32_t* y = b.rows + k * stride;
+            uint64_t* row = acc + (j + k) * BATCH_LANES;
+            for (size_t i = 0; i < BATCH_LANES; ++i) {
+                row[i] += static_cast<uint64_t>(x[i]) * y[i];
+            }
+        }
+        if (j + 1 - first == BATCH_CARRY_ROWS || j + 1 == a.limbs) {
+            for (size_t m = first; m < j + b.limbs; ++m) {
+                uint64_t* row = acc + m * BATCH_LANES;
+                uint64_t* next = row + BATCH_LANES;
+                for (size_t i = 0; i < BATCH_LANES; ++i) {
+                    uint64_t high = batch_divide_base(row[i]);
+                    row[i] -= high * BATCH_BASE;
+                    next[i] += high;
+                }
+            }
+            first = j + 1;
+        }
+    }
+    uint32_t nonzero[BATCH_LANES] = {};
+    for (size_t m = 0; m < out_limbs; ++m) {
+        const uint64_t* row = acc + m * BATCH_LANES;
+        uint32_t* o = out + m * stride;
+        for (size_t i = 0; i < BATCH_LANES; ++i) {
+            o[i] = static_cast<uint32_t>(row[i]);
+            nonzero[i] |= o[i];
+        }
+    }
+    for (size_t i = 0; i < BATCH_LANES; ++i) {
+        bool negative = (a.negative[i] != b.negative[i]);
+        out_negative[i] = (negative && nonzero[i] != 0 ? 1 : 0);
+    }
+}
+
+template <typename Func>
+void batch_for_blocks(size_t blocks, ThreadPool* pool, Func func) {
+    if (pool != nullptr) {
+        pool->parallelFor(0, blocks, BATCH_GRAIN, func);
+    } else {
+        for (size_t block = 0; block < blocks; ++block) {
+            func(block);
+        }
+    }
+}
+
+}  // namespace
+
+const size_t BigIntegerColumn::LANES;
+
+BigIntegerColumn::BigIntegerColumn(size_t size, size_t limbs) {
+    reshape(size, limbs);
+}
+
+BigIntegerColumn::BigIntegerColumn(const BigInteger* values, size_t size) {
+    size_t limbs = 1;
+    for (size_t i = 0; i < size; ++i) {
+        limbs = std::max(limbs, values[i].digits_.size());
+    }
+    reshape(size, limbs);
+    for (size_t i = 0; i < size; ++i) {
+        set(i, values[i]);
+    }
+}
+
+BigIntegerColumn::BigIntegerColumn(const std::vector<BigInteger>& values)
+    : BigIntegerColumn(values.data(), values.size()) {}
+
+size_t BigIntegerColumn::size() const {
+    return size_;
+}
+
+size_t BigIntegerColumn::limbs() const {
+    return limbs_;
+}
+
+void BigIntegerColumn::reshape(size_t size, size_t limbs) {
+    size_ = size;
+    limbs_ = limbs;
+    stride_ = (size + LANES - 1) / LANES * LANES;
+    digits_.assign(stride_ * limbs_, 0);
+    negative_.assign(stride_, 0);
+}
+
+// Like reshape, but leaves the contents undefined for a kernel to fill.
+void BigIntegerColumn::prepare(size_t size, size_t limbs) {
+    size_ = size;
+    limbs_ = limbs;
+    stride_ = (size + LANES - 1) / LANES * LANES;
+    digits_.resize(stride_ * limbs_);
+    negative_.resize(stride_);
+}
+
+BigInteger BigIntegerColumn::get(size_t index) const {
+    assert(index < size_);
+    BigInteger result;
+    result.digits_.resize(limbs_);
+    for (size_t j = 0; j < limbs_; ++j) {
+        result.digits_[j] = limb(j)[index];
+    }
+    result.clearZeros();
+    result.sign_ = (negative_[index] != 0 ? Sign::NEGATIVE : Sign::POSITIVE);
+    return result;
+}
+
+void BigIntegerColumn::set(size_t index, const BigInteger& value) {
+    assert(index < size_);
+    if (value.digits_.size() > limbs_) {
+        limbs_ = value.digits_.size();
+        digits_.resize(stride_ * limbs_, 0);
+    }
+    for (size_t j = 0; j < limbs_; ++j) {
+        limb(j)[index] = (j < value.digits_.size() ? static_cast<uint32_t>(value.digits_[j]) : 0);
+    }
+    negative_[index] = (value.getSign() == Sign::NEGATIVE ? 1 : 0);
+}
+
+std::vector<BigInteger> BigIntegerColumn::toVector() const {
+    std::vector<BigInteger> result;
+    result.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        result.push_back(get(i));
+    }
+    return result;
+}
+
+uint32_t* BigIntegerColumn::limb(size_t j) {
+    return digits_.data() + j * stride_;
+}
+
+const uint32_t* BigIntegerColumn::limb(size_t j) const {
+    return digits_.data() + j * stride_;
+}
+
+bool BigIntegerColumn::isNegative(size_t index) const {
+    return negative_[index] != 0;
+}
+
+void BigIntegerColumn::addOrSubtract(const BigIntegerColumn& a, const BigIntegerColumn& b,
+                                     bool subtract, BigIntegerColumn& out, ThreadPool* pool) {
+    assert(a.size_ == b.size_ && &out != &a && &out != &b);
+    out.prepare(a.size_, std::max(a.limbs_, b.limbs_) + 1);
+    batch_for_blocks(out.stride_ / LANES, pool, [&](size_t block) {
+        size_t offset = block * LANES;
+        batch_add_block({a.digits_.data() + offset, a.limbs_, a.negative_.data() + offset},
+                        {b.digits_.data() + offset, b.limbs_, b.negative_.data() + offset},
+                        subtract, out.stride_, out.digits_.data() + offset, out.limbs_,
+                        out.negative_.data() + offset);
+    });
+}
+
+void batchAdd(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+              ThreadPool* pool) {
+    BigIntegerColumn::addOrSubtract(a, b, false, out, pool);
+}
+
+void batchSubtract(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+                   ThreadPool* pool) {
+    BigIntegerColumn::addOrSubtract(a, b, true, out, pool);
+}
+
+void batchMultiply(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+                   ThreadPool* pool) {
+    assert(a.size_ == b.size_ && &out != &a && &out != &b);
+    out.prepare(a.size_, a.limbs_ + b.limbs_);
+    batch_for_blocks(out.stride_ / BigIntegerColumn::LANES, pool, [&](size_t block) {
+        size_t offset = block * BigIntegerColumn::LANES;
+        std::vector<uint64_t> acc((out.limbs_ + 1) * BigIntegerColumn::LANES);
+        batch_multiply_block({a.digits_.data() + offset, a.limbs_, a.negative_.data() + offset},
+                             {b.digits_.data() + offset, b.limbs_, b.negative_.data() + offset},
+                             a.stride_, out.digits_.data() + offset, out.negative_.data() + offset,
+                             acc.data());
+    });
+}
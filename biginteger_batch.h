@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "biginteger.h"
+#include "thread_pool.h"
+
+// A column of BigIntegers in structure-of-arrays form: limb j of every
+// element is stored contiguously, as 32-bit base 10^9 digits, so that
+// element-wise arithmetic runs down the column in SIMD lanes. Every
+// element has the same number of limbs, the high ones zero-padded, and
+// each limb row is padded with zero elements to a whole number of LANES.
+class BigIntegerColumn {
+  public:
+    static const size_t LANES = 64;
+
+    BigIntegerColumn() = default;
+    // `size` zeros of `limbs` limbs each.
+    BigIntegerColumn(size_t size, size_t limbs);
+    BigIntegerColumn(const BigInteger* values, size_t size);
+    explicit BigIntegerColumn(const std::vector<BigInteger>& values);
+
+    size_t size() const;
+    size_t limbs() const;
+    // Sets the shape and zeroes every element, keeping the storage when
+    // it is already large enough.
+    void reshape(size_t size, size_t limbs);
+    BigInteger get(size_t index) const;
+    // The column is widened if value does not fit.
+    void set(size_t index, const BigInteger& value);
+    std::vector<BigInteger> toVector() const;
+
+    // Row of limb j, LANES-padded.
+    uint32_t* limb(size_t j);
+    const uint32_t* limb(size_t j) const;
+    bool isNegative(size_t index) const;
+
+  private:
+    friend void batchAdd(const BigIntegerColumn& a, const BigIntegerColumn& b,
+                         BigIntegerColumn& out, ThreadPool* pool);
+    friend void batchSubtract(const BigIntegerColumn& a, const BigIntegerColumn& b,
+                              BigIntegerColumn& out, ThreadPool* pool);
+    friend void batchMultiply(const BigIntegerColumn& a, const BigIntegerColumn& b,
+                              BigIntegerColumn& out, ThreadPool* pool);
+
+    void prepare(size_t size, size_t limbs);
+    static void addOrSubtract(const BigIntegerColumn& a, const BigIntegerColumn& b,
+                              bool subtract, BigIntegerColumn& out, ThreadPool* pool);
+
+    size_t size_ = 0;
+    size_t limbs_ = 0;
+    size_t stride_ = 0;
+    std::vector<uint32_t> digits_;
+    std::vector<uint8_t> negative_;
+};
+
+// Element-wise out[i] = a[i] op b[i] for columns of equal size. out is
+// reshaped to fit the results (its storage is reused when large enough)
+// and must not be one of the inputs. With a pool, the column is split
+// into blocks of lanes that run in parallel.
+void batchAdd(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+              ThreadPool* pool = nullptr);
+
+void batchSubtract(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+                   ThreadPool* pool = nullptr);
+
+void batchMultiply(const BigIntegerColumn& a, const BigIntegerColumn& b, BigIntegerColumn& out,
+                   ThreadPool* pool = nullptr);
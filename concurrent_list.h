@@ -0,0 +1,336 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+
+// Lock-free sorted list (Harris-Michael) with hazard pointer reclamation.
+// Every value is stored at most once; erase marks the low bit of the
+// node's next pointer before unlinking it. Retired nodes are returned to
+// the allocator only after no thread holds a hazard pointer to them, so
+// the allocator itself must be safe to call from several threads.
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentList {
+  private:
+    struct Node {
+        T value;
+        std::atomic<uintptr_t> next;
+        Node* retired_next = nullptr;
+
+        Node(const T& val, uintptr_t nxt)
+            : value(val), next(nxt) {}
+    };
+
+    static const size_t MAX_THREADS = 128;
+    static const size_t HAZARDS_PER_THREAD = 2;
+
+  public:
+    // A thread frees its retired nodes once it holds this many, so fewer
+    // than this many per thread wait to be returned to the allocator.
+    static const size_t RETIRE_THRESHOLD = 2 * MAX_THREADS * HAZARDS_PER_THREAD;
+
+  private:
+    struct alignas(64) HazardRecord {
+        std::atomic<bool> active{false};
+        std::atomic<Node*> hazards[HAZARDS_PER_THREAD]{};
+        Node* retired = nullptr;
+        size_t retired_count = 0;
+    };
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using NodeAlloc = typename AllocTraits::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+    std::atomic<uintptr_t> _head{0};
+    std::atomic<size_t> _size{0};
+    HazardRecord _records[MAX_THREADS];
+    NodeAlloc _node_alloc;
+    uint64_t _id;
+
+    static inline std::atomic<uint64_t> _next_id{1};
+    // The record this thread last used in list _cached_id, tried first.
+    static inline thread_local uint64_t _cached_id = 0;
+    static inline thread_local size_t _cached_record = 0;
+
+    static Node* pointer(uintptr_t link) {
+        return reinterpret_cast<Node*>(link & ~uintptr_t(1));
+    }
+
+    static bool marked(uintptr_t link) {
+        return (link & 1) != 0;
+    }
+
+    static uintptr_t link(Node* node, bool mark = false) {
+        return reinterpret_cast<uintptr_t>(node) | uintptr_t(mark);
+    }
+
+    class Guard {
+      public:
+        explicit Guard(ConcurrentList& list)
+            : _list(list), _record(list.acquireRecord()) {}
+        Guard(const Guard&) = delete;
+        ~Guard() {
+            for (auto& hazard : _record->hazards) {
+                hazard.store(nullptr, std::memory_order_release);
+            }
+            _record->active.store(false, std::memory_order_release);
+        }
+
+        void protect(size_t index, Node* node) {
+            _record->hazards[index].store(node, std::memory_order_seq_cst);
+        }
+
+        void retire(Node* node) {
+            node->retired_next = _record->retired;
+            _record->retired = node;
+            if (++_record->retired_count >= RETIRE_THRESHOLD) {
+                _list.scan(*_record);
+            }
+        }
+
+      private:
+        ConcurrentList& _list;
+        HazardRecord* _record;
+    };
+
+    struct Position {
+        std::atomic<uintptr_t>* prev;
+        Node* cur;
+        Node* next;
+    };
+
+    bool tryAcquire(HazardRecord& record) {
+        bool expected = false;
+        return !record.active.load(std::memory_order_relaxed) &&
+               record.active.compare_exchange_strong(expected, true, std::memory_order_acquire);
+    }
+
+    // The scan starts from the first record, so with n threads only the
+    // first n records are ever used.
+    HazardRecord* acquireRecord() {
+        if (_cached_id == _id && tryAcquire(_records[_cached_record])) {
+            return &_records[_cached_record];
+        }
+        while (true) {
+            for (size_t i = 0; i < MAX_THREADS; ++i) {
+                if (tryAcquire(_records[i])) {
+                    _cached_id = _id;
+                    _cached_record = i;
+                    return &_records[i];
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void scan(HazardRecord& record) {
+        Node* protected_nodes[MAX_THREADS * HAZARDS_PER_THREAD];
+        size_t count = 0;
+        for (auto& other : _records) {
+            for (auto& hazard : other.hazards) {
+                Node* node = hazard.load(std::memory_order_seq_cst);
+                if (node != nullptr) {
+                    protected_nodes[count++] = node;
+                }
+            }
+        }
+
+        std::sort(protected_nodes, protected_nodes + count);
+
+        Node* keep = nullptr;
+        size_t kept = 0;
+        Node* node = record.retired;
+        while (node != nullptr) {
+            Node* next = node->retired_next;
+            if (std::binary_search(protected_nodes, protected_nodes + count, node)) {
+                node->retired_next = keep;
+                keep = node;
+                ++kept;
+            } else {
+                destroyNode(node);
+            }
+            node = next;
+        }
+        record.retired = keep;
+        record.retired_count = kept;
+    }
+
+    void destroyNode(Node* node) {
+        NodeAllocTraits::destroy(_node_alloc, node);
+        NodeAllocTraits::deallocate(_node_alloc, node, 1);
+    }
+
+    // Positions `prev` at the link that points to the first node whose
+    // value is not less than `value`. Marked nodes met on the way are
+    // unlinked and retired. On return one hazard covers `cur` and the other
+    // covers the node owning `prev`: stepping forward hands cur's hazard
+    // over to the new prev, so each visited node costs one hazard store.
+    bool find(const T& value, Position& pos, Guard& guard) {
+        size_t slot;
+    retry:
+        slot = 0;
+        pos.prev = &_head;
+        pos.cur = pointer(pos.prev->load(std::memory_order_acquire));
+        while (pos.cur != nullptr) {
+            guard.protect(slot, pos.cur);
+            if (pos.prev->load(std::memory_order_acquire) != link(pos.cur)) {
+                goto retry;
+            }
+            uintptr_t next_link = pos.cur->next.load(std::memory_order_acquire);
+            pos.next = pointer(next_link);
+            if (marked(next_link)) {
+                uintptr_t expected = link(pos.cur);
+                if (!pos.prev->compare_exchange_strong(expected, link(pos.next),
+                                                       std::memory_order_acq_rel)) {
+                    goto retry;
+                }
+                guard.retire(pos.cur);
+            } else {
+                if (!(pos.cur->value < value)) {
+                    return !(value < pos.cur->value);
+                }
+                slot ^= 1;
+                pos.prev = &pos.cur->next;
+            }
+            pos.cur = pos.next;
+        }
+        pos.next = nullptr;
+        return false;
+    }
+
+  public:
+    ConcurrentList(const Alloc& alloc = Alloc())
+        : _node_alloc(alloc), _id(_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+    ConcurrentList(const ConcurrentList& other) = delete;
+    ConcurrentList& operator=(const ConcurrentList& other) = delete;
+
+    bool insert(const T& value) {
+        Guard guard(*this);
+        Position pos{};
+        Node* node = nullptr;
+        while (true) {
+            if (find(value, pos, guard)) {
+                if (node != nullptr) {
+                    destroyNode(node);
+                }
+                return false;
+            }
+            if (node == nullptr) {
+                node = NodeAllocTraits::allocate(_node_alloc, 1);
+                try {
+                    NodeAllocTraits::construct(_node_alloc, node, value, link(pos.cur));
+                } catch (...) {
+                    NodeAllocTraits::deallocate(_node_alloc, node, 1);
+                    throw;
+                }
+            } else {
+                node->next.store(link(pos.cur), std::memory_order_relaxed);
+            }
+            uintptr_t expected = link(pos.cur);
+            if (pos.prev->compare_exchange_strong(expected, link(node),
+                                                  std::memory_order_acq_rel)) {
+                _size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    bool erase(const T& value) {
+        Guard guard(*this);
+        Position pos{};
+        while (true) {
+            if (!find(value, pos, guard)) {
+                return false;
+            }
+            uintptr_t expected = link(pos.next);
+            if (!pos.cur->next.compare_exchange_strong(expected, link(pos.next, true),
+                                                       std::memory_order_acq_rel)) {
+                continue;
+            }
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            expected = link(pos.cur);
+            if (pos.prev->compare_exchange_strong(expected, link(pos.next),
+                                                  std::memory_order_acq_rel)) {
+                guard.retire(pos.cur);
+            } else {
+                find(value, pos, guard);
+            }
+            return true;
+        }
+    }
+
+    bool contains(const T& value) {
+        Guard guard(*this);
+        Position pos{};
+        return find(value, pos, guard);
+    }
+
+    // Visits the live values in ascending order. Values inserted or erased
+    // concurrently may or may not be seen, but none is visited twice.
+    template <typename Func>
+    void for_each(Func func) {
+        Guard guard(*this);
+        std::optional<T> last;
+        size_t slot;
+    retry:
+        slot = 0;
+        std::atomic<uintptr_t>* prev = &_head;
+        Node* cur = pointer(prev->load(std::memory_order_acquire));
+        while (cur != nullptr) {
+            guard.protect(slot, cur);
+            if (prev->load(std::memory_order_acquire) != link(cur)) {
+                goto retry;
+            }
+            uintptr_t next_link = cur->next.load(std::memory_order_acquire);
+            Node* next = pointer(next_link);
+            if (marked(next_link)) {
+                uintptr_t expected = link(cur);
+                if (!prev->compare_exchange_strong(expected, link(next),
+                                                   std::memory_order_acq_rel)) {
+                    goto retry;
+                }
+                guard.retire(cur);
+            } else {
+                if (!last || *last < cur->value) {
+                    func(static_cast<const T&>(cur->value));
+                    last = cur->value;
+                }
+                slot ^= 1;
+                prev = &cur->next;
+            }
+            cur = next;
+        }
+    }
+
+    size_t size() const {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    Alloc get_allocator() const {
+        return _node_alloc;
+    }
+
+    ~ConcurrentList() {
+        Node* node = pointer(_head.load(std::memory_order_relaxed));
+        while (node != nullptr) {
+            Node* next = pointer(node->next.load(std::memory_order_relaxed));
+            destroyNode(node);
+            node = next;
+        }
+        for (auto& record : _records) {
+            node = record.retired;
+            while (node != nullptr) {
+                Node* next = node->retired_next;
+                destroyNode(node);
+                node = next;
+            }
+        }
+    }
+};
@@ -0,0 +1,217 @@
+// Stress test and throughput benchmark for ConcurrentList, built as its
+// own executable:
+//     g++ -std=c++17 -O2 -pthread concurrent_list_stress.cpp -o concurrent_list_stress
+// Exits with a non-zero status if a check fails.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "concurrent_list.h"
+#include "list.h"
+
+namespace {
+
+std::atomic<long> live_nodes{0};
+
+// Counts live allocations, so that leaked or doubly freed nodes show up.
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        live_nodes.fetch_add(static_cast<long>(count), std::memory_order_relaxed);
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* ptr, size_t count) {
+        live_nodes.fetch_sub(static_cast<long>(count), std::memory_order_relaxed);
+        std::allocator<T>().deallocate(ptr, count);
+    }
+
+    bool operator==(const CountingAllocator&) const {
+        return true;
+    }
+
+    bool operator!=(const CountingAllocator&) const {
+        return false;
+    }
+};
+
+// The baseline: a sorted List behind one mutex.
+class MutexList {
+  public:
+    bool insert(int value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = lowerBound(value);
+        if (it != _list.end() && *it == value) {
+            return false;
+        }
+        _list.insert(it, value);
+        return true;
+    }
+
+    bool erase(int value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = lowerBound(value);
+        if (it == _list.end() || *it != value) {
+            return false;
+        }
+        _list.erase(it);
+        return true;
+    }
+
+    bool contains(int value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = lowerBound(value);
+        return it != _list.end() && *it == value;
+    }
+
+  private:
+    List<int>::iterator lowerBound(int value) {
+        auto it = _list.begin();
+        while (it != _list.end() && *it < value) {
+            ++it;
+        }
+        return it;
+    }
+
+    List<int> _list;
+    std::mutex _mutex;
+};
+
+bool check(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+    }
+    return condition;
+}
+
+// Each writer owns the keys equal to its index modulo `writers`: it
+// inserts all of them, erases the odd ones and re-inserts every fourth
+// odd one, while readers run contains() and for_each() over the whole
+// list. Afterwards exactly the surviving keys must be present, and
+// every node that was erased must have been freed, apart from those
+// still waiting in the per-thread retire lists.
+bool stress(int writers, int readers, int keys_per_writer) {
+    using StressList = ConcurrentList<int, CountingAllocator<int>>;
+    bool ok = true;
+    {
+        StressList list;
+        std::atomic<bool> done{false};
+        std::atomic<bool> ordered{true};
+        std::vector<std::thread> threads;
+        for (int w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                for (int i = 0; i < keys_per_writer; ++i) {
+                    list.insert(i * writers + w);
+                }
+                for (int i = 1; i < keys_per_writer; i += 2) {
+                    list.erase(i * writers + w);
+                }
+                for (int i = 1; i < keys_per_writer; i += 4) {
+                    list.insert(i * writers + w);
+                }
+            });
+        }
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                std::mt19937 rng(r);
+                while (!done.load(std::memory_order_acquire)) {
+                    list.contains(static_cast<int>(rng() % (keys_per_writer * writers)));
+                    int last = -1;
+                    list.for_each([&](int value) {
+                        if (value <= last) {
+                            ordered.store(false, std::memory_order_relaxed);
+                        }
+                        last = value;
+                    });
+                }
+            });
+        }
+        for (int w = 0; w < writers; ++w) {
+            threads[w].join();
+        }
+        done.store(true, std::memory_order_release);
+        for (size_t t = writers; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+
+        std::vector<int> expected;
+        for (int key = 0; key < keys_per_writer * writers; ++key) {
+            int i = key / writers;
+            if (i % 2 == 0 || i % 4 == 1) {
+                expected.push_back(key);
+            }
+        }
+        std::vector<int> actual;
+        list.for_each([&](int value) { actual.push_back(value); });
+        ok &= check(ordered.load(), "for_each visits values in ascending order");
+        ok &= check(actual == expected, "list holds exactly the surviving keys");
+        ok &= check(list.size() == expected.size(), "size() matches the contents");
+        // Fewer than RETIRE_THRESHOLD nodes wait per thread that used the
+        // list; the other erased nodes must already be freed.
+        long pending = live_nodes.load() - static_cast<long>(expected.size());
+        long bound = static_cast<long>((writers + readers) * StressList::RETIRE_THRESHOLD);
+        ok &= check(pending >= 0 && pending < bound, "retired nodes are reclaimed");
+    }
+    ok &= check(live_nodes.load() == 0, "every node is freed by the destructor");
+    return ok;
+}
+
+template <typename ListType>
+double throughput(ListType& list, int threads, int ops_per_thread, int key_range) {
+    for (int key = 0; key < key_range; key += 2) {
+        list.insert(key);
+    }
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < ops_per_thread; ++i) {
+                int key = static_cast<int>(rng() % key_range);
+                unsigned op = rng() % 10;
+                if (op == 0) {
+                    list.insert(key);
+                } else if (op == 1) {
+                    list.erase(key);
+                } else {
+                    list.contains(key);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * static_cast<double>(ops_per_thread) / elapsed.count();
+}
+
+}  // namespace
+
+int main() {
+    bool ok = stress(4, 2, 2000);
+    ok &= stress(8, 4, 500);
+    std::printf("stress: %s\n", ok ? "ok" : "FAILED");
+
+    const int ops_per_thread = 100000;
+    const int key_range = 256;
+    std::printf("threads  ConcurrentList ops/s  mutex List ops/s\n");
+    for (int threads : {1, 2, 4, 8}) {
+        ConcurrentList<int> lock_free;
+        MutexList locked;
+        double lock_free_rate = throughput(lock_free, threads, ops_per_thread, key_range);
+        double locked_rate = throughput(locked, threads, ops_per_thread, key_range);
+        std::printf("%7d  %20.0f  %16.0f\n", threads, lock_free_rate, locked_rate);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,12 +1,13 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <memory>
 
 const size_t BUCKET_SIZE = 32;
 const size_t DEFAULT_SIZE_EXT = 10;
 const size_t NOTHING = BUCKET_SIZE * 2;
 
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 class Deque {
   private:
     struct Node {
@@ -15,30 +16,59 @@ class Deque {
         size_t end = NOTHING;
     };
 
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using NodeAlloc = typename AllocTraits::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+    mutable Alloc _alloc;
     mutable size_t external_size{};
     mutable Node* external_array;
     mutable size_t front_pos{};
     mutable size_t back_pos{};
     mutable size_t _size{};
 
+    T* allocate_bucket() const {
+        return AllocTraits::allocate(_alloc, BUCKET_SIZE);
+    }
+
+    void deallocate_bucket(T* ptr) const {
+        if (ptr != nullptr) {
+            AllocTraits::deallocate(_alloc, ptr, BUCKET_SIZE);
+        }
+    }
+
+    Node* allocate_external(size_t count) const {
+        NodeAlloc node_alloc(_alloc);
+        Node* array = NodeAllocTraits::allocate(node_alloc, count);
+        for (size_t i = 0; i < count; ++i) {
+            NodeAllocTraits::construct(node_alloc, array + i);
+        }
+        return array;
+    }
+
+    void deallocate_external(Node* array, size_t count) const {
+        NodeAlloc node_alloc(_alloc);
+        NodeAllocTraits::deallocate(node_alloc, array, count);
+    }
+
     void increase_external_array() const {
         size_t real_size = back_pos - front_pos + 1;
-        Node* new_ext_arr = new Node[real_size * 3];
+        Node* new_ext_arr = allocate_external(real_size * 3);
         for (size_t i = 0; i < external_size; ++i) {
             if (i <= std::min(back_pos, external_size - 1)) {
                 new_ext_arr[real_size + (i - front_pos)] = external_array[i];
-            } else if (external_array[i].ptr != nullptr) {
-                delete[] reinterpret_cast<char*>(external_array[i].ptr);
+            } else {
+                deallocate_bucket(external_array[i].ptr);
             }
         }
-        delete[] external_array;
+        deallocate_external(external_array, external_size);
         external_array = new_ext_arr;
         external_size = real_size * 3;
         front_pos = real_size;
         back_pos = real_size * 2 - 1;
     }
 
-    void swap(Deque<T>& deque) {
+    void swap(Deque& deque) {
         std::swap(external_size, deque.external_size);
         std::swap(external_array, deque.external_array);
         std::swap(front_pos, deque.front_pos);
@@ -198,8 +228,18 @@ class Deque {
                         external_array[front_pos].ptr + begin);
     }
 
-    Deque<T>& operator=(Deque<T> deque) {
-        swap(deque);
+    Deque& operator=(const Deque& deque) {
+        if (this == &deque) {
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            Deque copy(deque, deque._alloc);
+            swap(copy);
+            std::swap(_alloc, copy._alloc);
+        } else {
+            Deque copy(deque, _alloc);
+            swap(copy);
+        }
         return *this;
     }
 
@@ -276,9 +316,10 @@ class Deque {
         return crend();
     }
 
-    explicit Deque()
-        : external_size(DEFAULT_SIZE_EXT),
-          external_array(new Node[external_size]),
+    explicit Deque(const Alloc& alloc = Alloc())
+        : _alloc(alloc),
+          external_size(DEFAULT_SIZE_EXT),
+          external_array(allocate_external(external_size)),
           front_pos(external_size / 2),
           back_pos(external_size / 2),
           _size(0) {
@@ -286,9 +327,13 @@ class Deque {
         external_array[front_pos].end = 0;
     }
 
-    Deque(const Deque<T>& deque)
-        : external_size(deque.external_size),
-          external_array(new Node[external_size]),
+    Deque(const Deque& deque)
+        : Deque(deque, AllocTraits::select_on_container_copy_construction(deque._alloc)) {}
+
+    Deque(const Deque& deque, const Alloc& alloc)
+        : _alloc(alloc),
+          external_size(deque.external_size),
+          external_array(allocate_external(external_size)),
           front_pos(deque.front_pos),
           back_pos(deque.back_pos),
           _size(deque._size) {
@@ -299,33 +344,35 @@ class Deque {
         }
         try {
             for (; i <= back_pos; ++i) {
-                external_array[i].ptr =
-                    reinterpret_cast<T*>(new char[BUCKET_SIZE * sizeof(T)]);
+                external_array[i].ptr = allocate_bucket();
                 external_array[i].begin = deque.external_array[i].begin;
                 external_array[i].end = deque.external_array[i].end;
                 for (j = external_array[i].begin; j <= external_array[i].end;
                      ++j) {
-                    new (external_array[i].ptr + j)
-                        T(deque.external_array[i].ptr[j]);
+                    AllocTraits::construct(_alloc, external_array[i].ptr + j,
+                                           deque.external_array[i].ptr[j]);
                 }
             }
         } catch (...) {
             for (size_t k = front_pos; k <= i; ++k) {
                 for (size_t l = external_array[k].begin;
                      l + 1 <= (k != i ? external_array[k].end + 1 : j); ++l) {
-                    (external_array[k].ptr + l)->~T();
+                    AllocTraits::destroy(_alloc, external_array[k].ptr + l);
                 }
-                delete[] reinterpret_cast<char*>(external_array[k].ptr);
+                deallocate_bucket(external_array[k].ptr);
             }
+            deallocate_external(external_array, external_size);
             throw;
         }
     }
 
-    explicit Deque(size_t count) : Deque(count, T()) {}
+    explicit Deque(size_t count, const Alloc& alloc = Alloc())
+        : Deque(count, T(), alloc) {}
 
-    explicit Deque(size_t count, const T& value)
-        : external_size((count - 1) / BUCKET_SIZE + 1),
-          external_array(new Node[external_size]),
+    explicit Deque(size_t count, const T& value, const Alloc& alloc = Alloc())
+        : _alloc(alloc),
+          external_size((count - 1) / BUCKET_SIZE + 1),
+          external_array(allocate_external(external_size)),
           front_pos(0),
           back_pos(external_size - 1),
           _size(count) {
@@ -334,12 +381,10 @@ class Deque {
             for (; i < external_size; ++i) {
                 size_t real_size_bucket =
                     (count > BUCKET_SIZE ? BUCKET_SIZE : count);
-                delete[] external_array[i].ptr;
-                external_array[i].ptr =
-                    reinterpret_cast<T*>(new char[BUCKET_SIZE * sizeof(T)]);
+                external_array[i].ptr = allocate_bucket();
                 external_array[i].begin = 0;
                 for (size_t j = 0; j < real_size_bucket; ++j) {
-                    new (external_array[i].ptr + j) T(value);
+                    AllocTraits::construct(_alloc, external_array[i].ptr + j, value);
                     external_array[i].end = j;
                 }
                 count -= real_size_bucket;
@@ -348,19 +393,20 @@ class Deque {
             for (size_t k = 0; k <= i; ++k) {
                 for (size_t l = external_array[k].begin;
                      l <= external_array[k].end; ++l) {
-                    (external_array[k].ptr + l)->~T();
+                    AllocTraits::destroy(_alloc, external_array[k].ptr + l);
                 }
-                delete[] reinterpret_cast<char*>(external_array[k].ptr);
+                deallocate_bucket(external_array[k].ptr);
             }
-            delete[] external_array;
+            deallocate_external(external_array, external_size);
             throw;
         }
     }
 
     void push_back(const T& value) {
         if (_size > 0 && external_array[back_pos].end + 1 < BUCKET_SIZE) {
-            new (external_array[back_pos].ptr + external_array[back_pos].end +
-                 1) T(value);
+            AllocTraits::construct(
+                _alloc, external_array[back_pos].ptr + external_array[back_pos].end + 1,
+                value);
             ++external_array[back_pos].end;
         } else {
             if (_size == 0) {
@@ -374,14 +420,13 @@ class Deque {
             }
             try {
                 if (external_array[back_pos].ptr == nullptr) {
-                    external_array[back_pos].ptr =
-                        reinterpret_cast<T*>(new char[BUCKET_SIZE * sizeof(T)]);
+                    external_array[back_pos].ptr = allocate_bucket();
                 }
-                new (external_array[back_pos].ptr) T(value);
+                AllocTraits::construct(_alloc, external_array[back_pos].ptr, value);
                 external_array[back_pos].begin = 0;
                 external_array[back_pos].end = 0;
             } catch (...) {
-                delete[] reinterpret_cast<char*>(external_array[back_pos].ptr);
+                deallocate_bucket(external_array[back_pos].ptr);
                 external_array[back_pos].ptr = nullptr;
                 if (_size != 0) {
                     --back_pos;
@@ -393,7 +438,8 @@ class Deque {
     }
 
     void pop_back() {
-        (external_array[back_pos].ptr + external_array[back_pos].end)->~T();
+        AllocTraits::destroy(_alloc,
+                             external_array[back_pos].ptr + external_array[back_pos].end);
         if (external_array[back_pos].end > 0) {
             --external_array[back_pos].end;
         } else {
@@ -409,7 +455,8 @@ class Deque {
     }
 
     void pop_front() {
-        (external_array[front_pos].ptr + external_array[front_pos].begin)->~T();
+        AllocTraits::destroy(_alloc,
+                             external_array[front_pos].ptr + external_array[front_pos].begin);
         if (external_array[front_pos].begin < BUCKET_SIZE - 1) {
             ++external_array[front_pos].begin;
         } else {
@@ -426,8 +473,9 @@ class Deque {
 
     void push_front(const T& value) {
         if (_size > 0 && external_array[front_pos].begin >= 1) {
-            new (external_array[front_pos].ptr +
-                 (external_array[front_pos].begin - 1)) T(value);
+            AllocTraits::construct(
+                _alloc, external_array[front_pos].ptr + (external_array[front_pos].begin - 1),
+                value);
             --external_array[front_pos].begin;
         } else {
             if (_size == 0) {
@@ -442,15 +490,14 @@ class Deque {
             }
             try {
                 if (external_array[front_pos].ptr == nullptr) {
-                    external_array[front_pos].ptr =
-                        reinterpret_cast<T*>(new char[BUCKET_SIZE * sizeof(T)]);
+                    external_array[front_pos].ptr = allocate_bucket();
                 }
-                new (external_array[front_pos].ptr + (BUCKET_SIZE - 1))
-                    T(value);
+                AllocTraits::construct(_alloc, external_array[front_pos].ptr + (BUCKET_SIZE - 1),
+                                       value);
                 external_array[front_pos].begin = BUCKET_SIZE - 1;
                 external_array[front_pos].end = BUCKET_SIZE - 1;
             } catch (...) {
-                delete[] reinterpret_cast<char*>(external_array[front_pos].ptr);
+                deallocate_bucket(external_array[front_pos].ptr);
                 external_array[front_pos].ptr = nullptr;
                 if (_size != 0) {
                     ++front_pos;
@@ -502,9 +549,9 @@ class Deque {
         }
         push_back(value);
         for (iterator it = end() - 1; it != where; --it) {
-            new (it.ptr_node->ptr + it.index) T(*(it - 1));
+            AllocTraits::construct(_alloc, it.ptr_node->ptr + it.index, *(it - 1));
         }
-        new (where.ptr_node->ptr + where.index) T(value);
+        AllocTraits::construct(_alloc, where.ptr_node->ptr + where.index, value);
     }
 
     void erase(iterator where) {
@@ -517,7 +564,7 @@ class Deque {
             return;
         }
         for (iterator it = where; it != end() - 1; ++it) {
-            new (it.ptr_node->ptr + it.index) T(*(it + 1));
+            AllocTraits::construct(_alloc, it.ptr_node->ptr + it.index, *(it + 1));
         }
         pop_back();
     }
@@ -527,11 +574,15 @@ class Deque {
             if (external_array[i].ptr != nullptr) {
                 for (size_t j = external_array[i].begin;
                      j <= external_array[i].end; ++j) {
-                    (external_array[i].ptr + j)->~T();
+                    AllocTraits::destroy(_alloc, external_array[i].ptr + j);
                 }
-                delete[] reinterpret_cast<char*>(external_array[i].ptr);
+                deallocate_bucket(external_array[i].ptr);
             }
         }
-        delete[] external_array;
+        deallocate_external(external_array, external_size);
+    }
+
+    Alloc get_allocator() const {
+        return _alloc;
     }
 };
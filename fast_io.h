@@ -0,0 +1,321 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "biginteger.h"
+#include "string.h"
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define FAST_IO_MMAP
+#endif
+
+// Reads whitespace-separated tokens from a FILE through a large buffer.
+// Opened by path, a regular file is mapped into memory instead, and
+// tokens are parsed in place without copying.
+class FastReader {
+  public:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    explicit FastReader(std::FILE* file = stdin) : _file(file), _buffer(new char[BUFFER_SIZE]) {}
+
+    explicit FastReader(const char* path) : _file(std::fopen(path, "rb")), _owns_file(true) {
+        if (_file == nullptr) {
+            return;
+        }
+#ifdef FAST_IO_MMAP
+        struct stat info;
+        if (fstat(fileno(_file), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* map = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE,
+                             fileno(_file), 0);
+            if (map != MAP_FAILED) {
+                madvise(map, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                _map_size = static_cast<size_t>(info.st_size);
+                _pos = static_cast<const char*>(map);
+                _end = _pos + _map_size;
+                return;
+            }
+        }
+#endif
+        _buffer.reset(new char[BUFFER_SIZE]);
+    }
+
+    FastReader(const FastReader& other) = delete;
+    FastReader& operator=(const FastReader& other) = delete;
+
+    // Points `data` at the next token. The view is valid until the next
+    // call; it refers to the buffer, the mapping or an internal scratch
+    // string when the token crosses a buffer boundary.
+    bool token(const char*& data, size_t& size) {
+        while (true) {
+            while (_pos != _end && isSpace(*_pos)) {
+                ++_pos;
+            }
+            if (_pos != _end) {
+                break;
+            }
+            if (!refill()) {
+                return _good = false;
+            }
+        }
+        const char* start = _pos;
+        while (_pos != _end && !isSpace(*_pos)) {
+            ++_pos;
+        }
+        if (_pos != _end || _map_size != 0) {
+            data = start;
+            size = static_cast<size_t>(_pos - start);
+            return _good = true;
+        }
+        _scratch.assign(start, _pos);
+        while (refill()) {
+            start = _pos;
+            while (_pos != _end && !isSpace(*_pos)) {
+                ++_pos;
+            }
+            _scratch.append(start, _pos);
+            if (_pos != _end) {
+                break;
+            }
+        }
+        data = _scratch.data();
+        size = _scratch.size();
+        return _good = true;
+    }
+
+    bool read(String& str) {
+        const char* data;
+        size_t size;
+        if (!token(data, size)) {
+            return false;
+        }
+        str.clear();
+        str.append(data, size);
+        return true;
+    }
+
+    bool read(BigInteger& big_integer) {
+        const char* data;
+        size_t size;
+        if (!token(data, size)) {
+            return false;
+        }
+        big_integer = BigInteger(data, size);
+        return true;
+    }
+
+    // Points `data` at the next `size` raw bytes, with the same lifetime
+    // as a token; fails if the input ends first.
+    bool bytes(size_t size, const char*& data) {
+        if (static_cast<size_t>(_end - _pos) >= size) {
+            data = _pos;
+            _pos += size;
+            return _good = true;
+        }
+        _scratch.assign(_pos, _end);
+        _pos = _end;
+        while (_scratch.size() < size && refill()) {
+            size_t count = std::min(size - _scratch.size(), static_cast<size_t>(_end - _pos));
+            _scratch.append(_pos, count);
+            _pos += count;
+        }
+        data = _scratch.data();
+        return _good = (_scratch.size() == size);
+    }
+
+    // A BigInteger in its serialized binary form (BigInteger::serialize),
+    // decoded straight from the buffer or mapping when it is contiguous.
+    bool readBinary(BigInteger& big_integer) {
+        const char* data;
+        if (!bytes(BigInteger::SERIALIZED_HEADER, data)) {
+            return false;
+        }
+        size_t size = BigInteger::serializedSize(data);
+        size_t rest = size - BigInteger::SERIALIZED_HEADER;
+        if (data + BigInteger::SERIALIZED_HEADER == _pos &&
+            static_cast<size_t>(_end - _pos) >= rest) {
+            _pos += rest;
+            return _good = (BigInteger::deserialize(data, size, big_integer) != 0);
+        }
+        _record.assign(data, BigInteger::SERIALIZED_HEADER);
+        if (!bytes(rest, data)) {
+            return false;
+        }
+        _record.append(data, rest);
+        return _good = (BigInteger::deserialize(_record.data(), size, big_integer) != 0);
+    }
+
+    template <typename T>
+    FastReader& operator>>(T& value) {
+        read(value);
+        return *this;
+    }
+
+    explicit operator bool() const {
+        return _good;
+    }
+
+    ~FastReader() {
+#ifdef FAST_IO_MMAP
+        if (_map_size != 0) {
+            munmap(const_cast<char*>(_end - _map_size), _map_size);
+        }
+#endif
+        if (_owns_file && _file != nullptr) {
+            std::fclose(_file);
+        }
+    }
+
+  private:
+    static bool isSpace(char ch) {
+        return ch == ' ' || (ch >= '\t' && ch <= '\r');
+    }
+
+    bool refill() {
+        if (_map_size != 0 || _file == nullptr) {
+            return false;
+        }
+        size_t count = std::fread(_buffer.get(), 1, BUFFER_SIZE, _file);
+        _pos = _buffer.get();
+        _end = _pos + count;
+        return count != 0;
+    }
+
+    std::FILE* _file;
+    bool _owns_file = false;
+    bool _good = true;
+    std::unique_ptr<char[]> _buffer;
+    size_t _map_size = 0;
+    const char* _pos = nullptr;
+    const char* _end = nullptr;
+    std::string _scratch;
+    std::string _record;
+};
+
+// Buffered writer; output is flushed when the buffer fills, on flush()
+// and on destruction. Writes larger than the buffer go straight through.
+class FastWriter {
+  public:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    explicit FastWriter(std::FILE* file = stdout) : _file(file), _buffer(new char[BUFFER_SIZE]) {}
+
+    explicit FastWriter(const char* path)
+        : _file(std::fopen(path, "wb")), _owns_file(true), _buffer(new char[BUFFER_SIZE]) {}
+
+    FastWriter(const FastWriter& other) = delete;
+    FastWriter& operator=(const FastWriter& other) = delete;
+
+    void write(const char* data, size_t size) {
+        if (_size + size > BUFFER_SIZE) {
+            flush();
+            if (size > BUFFER_SIZE) {
+                if (_file != nullptr) {
+                    std::fwrite(data, 1, size, _file);
+                }
+                return;
+            }
+        }
+        memcpy(_buffer.get() + _size, data, size);
+        _size += size;
+    }
+
+    FastWriter& operator<<(char ch) {
+        if (_size == BUFFER_SIZE) {
+            flush();
+        }
+        _buffer[_size++] = ch;
+        return *this;
+    }
+
+    FastWriter& operator<<(const char* str) {
+        write(str, strlen(str));
+        return *this;
+    }
+
+    FastWriter& operator<<(const StringView& view) {
+        write(view.data(), view.size());
+        return *this;
+    }
+
+    FastWriter& operator<<(const String& str) {
+        write(str.data(), str.size());
+        return *this;
+    }
+
+    FastWriter& operator<<(const BigInteger& big_integer) {
+        std::string str = big_integer.toString();
+        write(str.data(), str.size());
+        return *this;
+    }
+
+    // Serializes into the buffer, or through a temporary when the record
+    // is larger than the buffer.
+    void writeBinary(const BigInteger& big_integer) {
+        size_t size = big_integer.serializedSize();
+        if (_size + size > BUFFER_SIZE) {
+            flush();
+        }
+        if (size <= BUFFER_SIZE) {
+            _size += big_integer.serialize(_buffer.get() + _size);
+            return;
+        }
+        std::unique_ptr<char[]> record(new char[size]);
+        big_integer.serialize(record.get());
+        if (_file != nullptr) {
+            std::fwrite(record.get(), 1, size, _file);
+        }
+    }
+
+    // Like std::ostream without boolalpha: bool is 1 or 0, and the char
+    // types are written as characters rather than numbers.
+    FastWriter& operator<<(bool value) {
+        return *this << (value ? '1' : '0');
+    }
+
+    FastWriter& operator<<(signed char ch) {
+        return *this << static_cast<char>(ch);
+    }
+
+    FastWriter& operator<<(unsigned char ch) {
+        return *this << static_cast<char>(ch);
+    }
+
+    template <typename Int,
+              typename = std::enable_if_t<std::is_integral<Int>::value &&
+                                          !std::is_same<Int, bool>::value &&
+                                          !std::is_same<Int, char>::value &&
+                                          !std::is_same<Int, signed char>::value &&
+                                          !std::is_same<Int, unsigned char>::value>>
+    FastWriter& operator<<(Int value) {
+        char digits[24];
+        char* last = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        write(digits, static_cast<size_t>(last - digits));
+        return *this;
+    }
+
+    void flush() {
+        if (_size != 0 && _file != nullptr) {
+            std::fwrite(_buffer.get(), 1, _size, _file);
+        }
+        _size = 0;
+    }
+
+    ~FastWriter() {
+        flush();
+        if (_owns_file && _file != nullptr) {
+            std::fclose(_file);
+        } else if (_file != nullptr) {
+            std::fflush(_file);
+        }
+    }
+
+  private:
+    std::FILE* _file;
+    bool _owns_file = false;
+    std::unique_ptr<char[]> _buffer;
+    size_t _size = 0;
+};
@@ -0,0 +1,444 @@
+#pragma once
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "biginteger.h"
+
+// Signed integer of a compile-time width: Bits (a multiple of 64) bits in
+// two's complement, stored inline as little-endian 64-bit limbs, so it
+// never allocates. Arithmetic wraps modulo 2^Bits like the built-in
+// integers do. Everything except the BigInteger, string and stream
+// conversions is constexpr.
+template <size_t Bits>
+class FixedBigInteger {
+    static_assert(Bits > 0 && Bits % 64 == 0, "Bits must be a positive multiple of 64");
+
+    template <size_t>
+    friend class FixedBigInteger;
+
+  public:
+    static constexpr size_t LIMBS = Bits / 64;
+
+    constexpr FixedBigInteger() = default;
+
+    constexpr FixedBigInteger(int64_t n) {
+        limbs_[0] = static_cast<uint64_t>(n);
+        for (size_t i = 1; i < LIMBS; ++i) {
+            limbs_[i] = (n < 0 ? ~uint64_t(0) : 0);
+        }
+    }
+
+    // Sign-extends or truncates.
+    template <size_t OtherBits>
+    constexpr explicit FixedBigInteger(const FixedBigInteger<OtherBits>& other) {
+        uint64_t fill = (other.isNegative() ? ~uint64_t(0) : 0);
+        for (size_t i = 0; i < LIMBS; ++i) {
+            limbs_[i] = (i < other.LIMBS ? other.limbs_[i] : fill);
+        }
+    }
+
+    // Decimal digits with an optional leading sign; "'" separators are
+    // skipped.
+    constexpr FixedBigInteger(const char* str, size_t size) {
+        size_t start = 0;
+        bool negative = false;
+        if (size > 0 && (str[0] == '-' || str[0] == '+')) {
+            negative = (str[0] == '-');
+            start = 1;
+        }
+        for (size_t i = start; i < size; ++i) {
+            if (str[i] == '\'') {
+                continue;
+            }
+            assert(str[i] >= '0' && str[i] <= '9');
+            multiplyAdd(10, static_cast<uint64_t>(str[i] - '0'));
+        }
+        if (negative) {
+            negate();
+        }
+    }
+
+    constexpr explicit FixedBigInteger(const char* str) : FixedBigInteger(str, length(str)) {}
+
+    explicit FixedBigInteger(const std::string& str) : FixedBigInteger(str.data(), str.size()) {}
+
+    // Keeps the low Bits bits of value's two's complement.
+    explicit FixedBigInteger(const BigInteger& value) {
+        std::vector<uint64_t> magnitude = value.toBinary();
+        for (size_t i = 0; i < LIMBS && i < magnitude.size(); ++i) {
+            limbs_[i] = magnitude[i];
+        }
+        if (value.getSign() == Sign::NEGATIVE) {
+            negate();
+        }
+    }
+
+    BigInteger toBigInteger() const {
+        FixedBigInteger magnitude = abs();
+        BigInteger result = BigInteger::fromBinary(
+            std::vector<uint64_t>(magnitude.limbs_.begin(), magnitude.limbs_.end()));
+        if (isNegative()) {
+            result.invert();
+        }
+        return result;
+    }
+
+    explicit operator BigInteger() const {
+        return toBigInteger();
+    }
+
+    std::string toString() const {
+        const uint64_t chunk = 10000000000000000000ull;
+        FixedBigInteger magnitude = abs();
+        std::string result;
+        do {
+            uint64_t rem = magnitude.divideSmall(chunk);
+            for (int i = 0; i < 19; ++i) {
+                result += static_cast<char>('0' + rem % 10);
+                rem /= 10;
+            }
+        } while (!magnitude.isZero());
+        while (result.size() > 1 && result.back() == '0') {
+            result.pop_back();
+        }
+        if (isNegative()) {
+            result += '-';
+        }
+        return std::string(result.rbegin(), result.rend());
+    }
+
+    constexpr bool isNegative() const {
+        return (limbs_[LIMBS - 1] >> 63) != 0;
+    }
+
+    constexpr Sign getSign() const {
+        return isNegative() ? Sign::NEGATIVE : Sign::POSITIVE;
+    }
+
+    constexpr explicit operator bool() const {
+        return !isZero();
+    }
+
+    constexpr uint64_t limb(size_t index) const {
+        return limbs_[index];
+    }
+
+    constexpr FixedBigInteger abs() const {
+        return isNegative() ? -*this : *this;
+    }
+
+    constexpr FixedBigInteger operator-() const {
+        FixedBigInteger result = *this;
+        result.negate();
+        return result;
+    }
+
+    constexpr FixedBigInteger operator+() const {
+        return *this;
+    }
+
+    constexpr FixedBigInteger& operator+=(const FixedBigInteger& other) {
+        bool carry = false;
+        for (size_t i = 0; i < LIMBS; ++i) {
+            uint64_t sum = 0;
+            bool first = __builtin_add_overflow(limbs_[i], other.limbs_[i], &sum);
+            bool second = __builtin_add_overflow(sum, static_cast<uint64_t>(carry), &limbs_[i]);
+            carry = first || second;
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInteger& operator-=(const FixedBigInteger& other) {
+        bool borrow = false;
+        for (size_t i = 0; i < LIMBS; ++i) {
+            uint64_t diff = 0;
+            bool first = __builtin_sub_overflow(limbs_[i], other.limbs_[i], &diff);
+            bool second = __builtin_sub_overflow(diff, static_cast<uint64_t>(borrow), &limbs_[i]);
+            borrow = first || second;
+        }
+        return *this;
+    }
+
+    // Only the low LIMBS limbs of the product are formed; two's complement
+    // makes that correct for any signs.
+    constexpr FixedBigInteger& operator*=(const FixedBigInteger& other) {
+        std::array<uint64_t, LIMBS> result{};
+        for (size_t i = 0; i < LIMBS; ++i) {
+            if (limbs_[i] == 0) {
+                continue;
+            }
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < LIMBS; ++j) {
+                unsigned __int128 cur =
+                    static_cast<unsigned __int128>(limbs_[i]) * other.limbs_[j];
+                cur += result[i + j];
+                cur += carry;
+                result[i + j] = static_cast<uint64_t>(cur);
+                carry = static_cast<uint64_t>(cur >> 64);
+            }
+        }
+        limbs_ = result;
+        return *this;
+    }
+
+    // Truncates toward zero; the remainder takes the dividend's sign, as
+    // with BigInteger.
+    constexpr FixedBigInteger& operator/=(const FixedBigInteger& other) {
+        FixedBigInteger quotient;
+        FixedBigInteger remainder;
+        divide(*this, other, quotient, remainder);
+        return *this = quotient;
+    }
+
+    constexpr FixedBigInteger& operator%=(const FixedBigInteger& other) {
+        FixedBigInteger quotient;
+        FixedBigInteger remainder;
+        divide(*this, other, quotient, remainder);
+        return *this = remainder;
+    }
+
+    constexpr FixedBigInteger& operator++() {
+        return *this += 1;
+    }
+
+    constexpr FixedBigInteger operator++(int) {
+        FixedBigInteger copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    constexpr FixedBigInteger& operator--() {
+        return *this -= 1;
+    }
+
+    constexpr FixedBigInteger operator--(int) {
+        FixedBigInteger copy = *this;
+        --*this;
+        return copy;
+    }
+
+    friend constexpr FixedBigInteger operator+(FixedBigInteger a, const FixedBigInteger& b) {
+        return a += b;
+    }
+
+    friend constexpr FixedBigInteger operator-(FixedBigInteger a, const FixedBigInteger& b) {
+        return a -= b;
+    }
+
+    friend constexpr FixedBigInteger operator*(FixedBigInteger a, const FixedBigInteger& b) {
+        return a *= b;
+    }
+
+    friend constexpr FixedBigInteger operator/(FixedBigInteger a, const FixedBigInteger& b) {
+        return a /= b;
+    }
+
+    friend constexpr FixedBigInteger operator%(FixedBigInteger a, const FixedBigInteger& b) {
+        return a %= b;
+    }
+
+    friend constexpr bool operator==(const FixedBigInteger& a, const FixedBigInteger& b) {
+        for (size_t i = 0; i < LIMBS; ++i) {
+            if (a.limbs_[i] != b.limbs_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const FixedBigInteger& a, const FixedBigInteger& b) {
+        return !(a == b);
+    }
+
+    friend constexpr bool operator<(const FixedBigInteger& a, const FixedBigInteger& b) {
+        if (a.isNegative() != b.isNegative()) {
+            return a.isNegative();
+        }
+        return lessMagnitude(a.limbs_, b.limbs_);
+    }
+
+    friend constexpr bool operator>(const FixedBigInteger& a, const FixedBigInteger& b) {
+        return b < a;
+    }
+
+    friend constexpr bool operator<=(const FixedBigInteger& a, const FixedBigInteger& b) {
+        return !(b < a);
+    }
+
+    friend constexpr bool operator>=(const FixedBigInteger& a, const FixedBigInteger& b) {
+        return !(a < b);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const FixedBigInteger& value) {
+        return out << value.toString();
+    }
+
+  private:
+    using Limbs = std::array<uint64_t, LIMBS>;
+
+    static constexpr size_t length(const char* str) {
+        size_t size = 0;
+        while (str[size] != '\0') {
+            ++size;
+        }
+        return size;
+    }
+
+    static constexpr bool lessMagnitude(const Limbs& a, const Limbs& b) {
+        for (size_t i = LIMBS; i > 0; --i) {
+            if (a[i - 1] != b[i - 1]) {
+                return a[i - 1] < b[i - 1];
+            }
+        }
+        return false;
+    }
+
+    static constexpr size_t significantLimbs(const Limbs& a) {
+        size_t size = LIMBS;
+        while (size > 0 && a[size - 1] == 0) {
+            --size;
+        }
+        return size;
+    }
+
+    constexpr bool isZero() const {
+        return significantLimbs(limbs_) == 0;
+    }
+
+    constexpr void negate() {
+        bool carry = true;
+        for (size_t i = 0; i < LIMBS; ++i) {
+            carry = __builtin_add_overflow(~limbs_[i], static_cast<uint64_t>(carry), &limbs_[i]);
+        }
+    }
+
+    constexpr void multiplyAdd(uint64_t factor, uint64_t addend) {
+        uint64_t carry = addend;
+        for (size_t i = 0; i < LIMBS; ++i) {
+            unsigned __int128 cur = static_cast<unsigned __int128>(limbs_[i]) * factor + carry;
+            limbs_[i] = static_cast<uint64_t>(cur);
+            carry = static_cast<uint64_t>(cur >> 64);
+        }
+    }
+
+    // Divides the (unsigned) limbs in place and returns the remainder.
+    constexpr uint64_t divideSmall(uint64_t divisor) {
+        uint64_t rem = 0;
+        for (size_t i = LIMBS; i > 0; --i) {
+            unsigned __int128 cur = (static_cast<unsigned __int128>(rem) << 64) | limbs_[i - 1];
+            limbs_[i - 1] = static_cast<uint64_t>(cur / divisor);
+            rem = static_cast<uint64_t>(cur % divisor);
+        }
+        return rem;
+    }
+
+    // Knuth's algorithm D on the magnitudes, base 2^64.
+    static constexpr void divideMagnitude(const Limbs& u, const Limbs& v, Limbs& q, Limbs& r) {
+        size_t n = significantLimbs(v);
+        size_t m = significantLimbs(u);
+        assert(n > 0);
+        q = Limbs{};
+        r = Limbs{};
+        if (m < n || (m == n && lessMagnitude(u, v))) {
+            r = u;
+            return;
+        }
+        if (n == 1) {
+            FixedBigInteger quotient;
+            quotient.limbs_ = u;
+            r[0] = quotient.divideSmall(v[0]);
+            q = quotient.limbs_;
+            return;
+        }
+        int shift = __builtin_clzll(v[n - 1]);
+        std::array<uint64_t, LIMBS> vn{};
+        std::array<uint64_t, LIMBS + 1> un{};
+        for (size_t i = n - 1; i > 0; --i) {
+            vn[i] = (v[i] << shift) | (shift == 0 ? 0 : v[i - 1] >> (64 - shift));
+        }
+        vn[0] = v[0] << shift;
+        un[m] = (shift == 0 ? 0 : u[m - 1] >> (64 - shift));
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = (u[i] << shift) | (shift == 0 ? 0 : u[i - 1] >> (64 - shift));
+        }
+        un[0] = u[0] << shift;
+        for (size_t j = m - n + 1; j > 0; --j) {
+            size_t k = j - 1;
+            unsigned __int128 top =
+                (static_cast<unsigned __int128>(un[k + n]) << 64) | un[k + n - 1];
+            unsigned __int128 qhat = top / vn[n - 1];
+            unsigned __int128 rhat = top % vn[n - 1];
+            while ((qhat >> 64) != 0 ||
+                   qhat * vn[n - 2] > ((rhat << 64) | un[k + n - 2])) {
+                --qhat;
+                rhat += vn[n - 1];
+                if ((rhat >> 64) != 0) {
+                    break;
+                }
+            }
+            uint64_t carry = 0;
+            bool borrow = false;
+            for (size_t i = 0; i < n; ++i) {
+                unsigned __int128 product = qhat * vn[i] + carry;
+                carry = static_cast<uint64_t>(product >> 64);
+                uint64_t diff = 0;
+                bool first =
+                    __builtin_sub_overflow(un[i + k], static_cast<uint64_t>(product), &diff);
+                bool second =
+                    __builtin_sub_overflow(diff, static_cast<uint64_t>(borrow), &un[i + k]);
+                borrow = first || second;
+            }
+            uint64_t diff = 0;
+            bool first = __builtin_sub_overflow(un[k + n], carry, &diff);
+            bool second = __builtin_sub_overflow(diff, static_cast<uint64_t>(borrow), &un[k + n]);
+            if (first || second) {
+                --qhat;
+                bool add_carry = false;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t sum = 0;
+                    bool a = __builtin_add_overflow(un[i + k], vn[i], &sum);
+                    bool b =
+                        __builtin_add_overflow(sum, static_cast<uint64_t>(add_carry), &un[i + k]);
+                    add_carry = a || b;
+                }
+                un[k + n] += static_cast<uint64_t>(add_carry);
+            }
+            q[k] = static_cast<uint64_t>(qhat);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = (un[i] >> shift) | (shift == 0 ? 0 : un[i + 1] << (64 - shift));
+        }
+    }
+
+    static constexpr void divide(const FixedBigInteger& a, const FixedBigInteger& b,
+                                 FixedBigInteger& quotient, FixedBigInteger& remainder) {
+        divideMagnitude(a.abs().limbs_, b.abs().limbs_, quotient.limbs_, remainder.limbs_);
+        if (a.isNegative() != b.isNegative()) {
+            quotient.negate();
+        }
+        if (a.isNegative()) {
+            remainder.negate();
+        }
+    }
+
+    Limbs limbs_{};
+};
+
+using Int128 = FixedBigInteger<128>;
+using Int256 = FixedBigInteger<256>;
+using Int512 = FixedBigInteger<512>;
+
+// 123'456'789..._fbi is a FixedBigInteger just wide enough for its
+// digits, built at compile time; it converts explicitly to wider ones.
+template <char... Digits>
+constexpr auto operator""_fbi() {
+    constexpr char digits[] = {Digits...};
+    constexpr size_t count = sizeof...(Digits);
+    // log2(10) < 3.33, plus the sign bit.
+    constexpr size_t bits = (count * 333 + 99) / 100 + 1;
+    return FixedBigInteger<(bits + 63) / 64 * 64>(digits, count);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+// Canonicalizes equal values to one shared, immutable copy. intern()
+// returns the same pointer for every value equal to an earlier one, so
+// interned values can be compared and hashed by address, and repeats cost
+// a pointer instead of a copy. Pointers stay valid until clear() or the
+// table is destroyed. Safe to call from several threads.
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+class InternTable {
+  public:
+    InternTable() = default;
+    InternTable(const InternTable& other) = delete;
+    InternTable& operator=(const InternTable& other) = delete;
+
+    const T* intern(const T& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return &*_values.insert(value).first;
+    }
+
+    const T* intern(T&& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return &*_values.insert(std::move(value)).first;
+    }
+
+    // The interned copy of value, or nullptr if there is none.
+    const T* find(const T& value) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _values.find(value);
+        return it == _values.end() ? nullptr : &*it;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _values.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _values.clear();
+    }
+
+  private:
+    // Nodes of an unordered_set never move, which keeps the pointers
+    // handed out stable across rehashes.
+    std::unordered_set<T, Hash, Equal> _values;
+    mutable std::mutex _mutex;
+};
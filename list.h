@@ -1,6 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <memory>
 
 template <typename T, typename Alloc = std::allocator<T>>
@@ -18,12 +20,33 @@ class List {
 
     struct Node : BaseNode {
         T value;
+        // Whether the node lives in a Block; set after every construction.
+        bool pooled;
         Node(BaseNode* nxt, BaseNode* prv, const T& val)
             : BaseNode(nxt, prv), value(val) {}
         Node(BaseNode* nxt, BaseNode* prv)
             : BaseNode(nxt, prv), value(T()) {}
     };
 
+    // Nodes created by bulk operations come from Blocks, a header followed
+    // by up to MAX_BLOCK_NODES nodes. Such nodes can't be handed back to
+    // the allocator one by one, so erase keeps them in _free_nodes, where
+    // later inserts and bulk operations take them first, and each block is
+    // released whole in clear().
+    struct Block {
+        Block* next;
+        size_t slots;
+
+        Block(Block* nxt, size_t slts)
+            : next(nxt), slots(slts) {}
+    };
+
+    static constexpr size_t BLOCK_HEADER_SLOTS = (sizeof(Block) + sizeof(Node) - 1) / sizeof(Node);
+    static constexpr size_t MAX_BLOCK_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_SLOTS =
+        std::max<size_t>(MAX_BLOCK_BYTES / sizeof(Node), BLOCK_HEADER_SLOTS + 1);
+    static constexpr size_t MAX_BLOCK_NODES = MAX_BLOCK_SLOTS - BLOCK_HEADER_SLOTS;
+
     using AllocTraits = std::allocator_traits<Alloc>;
     using NodeAlloc = typename AllocTraits::template rebind_alloc<Node>;
     using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
@@ -31,6 +54,8 @@ class List {
     BaseNode _fake_node;
     size_t _size;
     NodeAlloc _node_alloc;
+    Block* _blocks = nullptr;
+    BaseNode* _free_nodes = nullptr;
 
     void swap(List& other) {
         std::swap(_fake_node.prev, other._fake_node.prev);
@@ -40,6 +65,125 @@ class List {
         std::swap(_size, other._size);
     }
 
+    static Node* blockNodes(Block* block) {
+        return reinterpret_cast<Node*>(block) + BLOCK_HEADER_SLOTS;
+    }
+
+    Node* allocateNode(bool& pooled) {
+        pooled = (_free_nodes != nullptr);
+        if (pooled) {
+            BaseNode* node = _free_nodes;
+            _free_nodes = node->next;
+            return static_cast<Node*>(node);
+        }
+        return NodeAllocTraits::allocate(_node_alloc, 1);
+    }
+
+    void deallocateNode(Node* node, bool pooled) {
+        if (pooled) {
+            _free_nodes = new (static_cast<void*>(node)) BaseNode(_free_nodes, nullptr);
+        } else {
+            NodeAllocTraits::deallocate(_node_alloc, node, 1);
+        }
+    }
+
+    // Builds `count` nodes in place and splices them before end(). Free
+    // nodes are used first; the rest come from new blocks of at most
+    // MAX_BLOCK_BYTES, so that large batches reuse memory the allocator
+    // already has instead of mapping fresh pages. A node is linked only
+    // once its value is built, so if a build throws, the list is left as it
+    // was and every reused node is back on the free list.
+    template <typename Builder>
+    void appendBatch(size_t count, Builder build) {
+        Block* old_blocks = _blocks;
+        Node* fresh = nullptr;
+        size_t fresh_left = 0;
+        BaseNode* first = &_fake_node;
+        BaseNode* prev = _fake_node.prev;
+        size_t created = 0;
+        size_t reused = 0;
+        try {
+            for (; created < count; ++created) {
+                Node* node;
+                BaseNode* rest = nullptr;
+                bool reuse = (_free_nodes != nullptr);
+                if (reuse) {
+                    node = static_cast<Node*>(_free_nodes);
+                    rest = _free_nodes->next;
+                } else {
+                    if (fresh_left == 0) {
+                        fresh_left = std::min(count - created, MAX_BLOCK_NODES);
+                        size_t slots = BLOCK_HEADER_SLOTS + fresh_left;
+                        Node* storage = NodeAllocTraits::allocate(_node_alloc, slots);
+                        _blocks = new (static_cast<void*>(storage)) Block(_blocks, slots);
+                        fresh = blockNodes(_blocks);
+                    }
+                    node = fresh;
+                }
+                try {
+                    build(node, &_fake_node, prev);
+                } catch (...) {
+                    // The node's links were written before the value threw.
+                    if (reuse) {
+                        new (static_cast<void*>(node)) BaseNode(rest, nullptr);
+                    }
+                    throw;
+                }
+                if (reuse) {
+                    _free_nodes = rest;
+                    ++reused;
+                } else {
+                    ++fresh;
+                    --fresh_left;
+                }
+                node->pooled = true;
+                if (created == 0) {
+                    first = node;
+                } else {
+                    prev->next = node;
+                }
+                prev = node;
+            }
+        } catch (...) {
+            BaseNode* node = first;
+            for (size_t i = 0; i < created; ++i) {
+                BaseNode* next = node->next;
+                NodeAllocTraits::destroy(_node_alloc, static_cast<Node*>(node));
+                if (i < reused) {
+                    deallocateNode(static_cast<Node*>(node), true);
+                }
+                node = next;
+            }
+            while (_blocks != old_blocks) {
+                Block* next = _blocks->next;
+                NodeAllocTraits::deallocate(_node_alloc, reinterpret_cast<Node*>(_blocks),
+                                            _blocks->slots);
+                _blocks = next;
+            }
+            throw;
+        }
+        if (created > 0) {
+            _fake_node.prev->next = first;
+            _fake_node.prev = prev;
+            _size += count;
+        }
+    }
+
+    template <typename InputIt>
+    void appendRange(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            appendBatch(std::distance(first, last), [&](Node* node, BaseNode* next, BaseNode* prev) {
+                NodeAllocTraits::construct(_node_alloc, node, next, prev, *first);
+                ++first;
+            });
+        } else {
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+        }
+    }
+
   public:
     template <bool is_const>
     class CommonIterator {
@@ -160,13 +304,15 @@ class List {
     iterator insert(const_iterator it, const Args&... args) {
         BaseNode* prev = it.getPtrNode()->prev;
         BaseNode* next = it.getPtrNode();
-        Node* ptr = NodeAllocTraits::allocate(_node_alloc, 1);
+        bool pooled;
+        Node* ptr = allocateNode(pooled);
         try {
             NodeAllocTraits::construct(_node_alloc, ptr, next, prev, args...);
         } catch (...) {
-            NodeAllocTraits::deallocate(_node_alloc, ptr, 1);
+            deallocateNode(ptr, pooled);
             throw;
         }
+        ptr->pooled = pooled;
         prev->next = ptr;
         next->prev = ptr;
         ++_size;
@@ -178,8 +324,10 @@ class List {
         BaseNode* next = it.getPtrNode()->next;
         prev->next = next;
         next->prev = prev;
-        NodeAllocTraits::destroy(_node_alloc, static_cast<Node*>(it.getPtrNode()));
-        NodeAllocTraits::deallocate(_node_alloc, static_cast<Node*>(it.getPtrNode()), 1);
+        Node* node = static_cast<Node*>(it.getPtrNode());
+        bool pooled = node->pooled;
+        NodeAllocTraits::destroy(_node_alloc, node);
+        deallocateNode(node, pooled);
         --_size;
         return iterator(static_cast<BaseNode*>(next));
     }
@@ -208,57 +356,98 @@ class List {
         return _size == 0;
     }
 
+    // Tears the whole list down without relinking: values are destroyed in
+    // one pass and bulk blocks are released with one call each.
+    void clear() {
+        BaseNode* node = _fake_node.next;
+        while (node != &_fake_node) {
+            BaseNode* next = node->next;
+            bool pooled = static_cast<Node*>(node)->pooled;
+            NodeAllocTraits::destroy(_node_alloc, static_cast<Node*>(node));
+            if (!pooled) {
+                NodeAllocTraits::deallocate(_node_alloc, static_cast<Node*>(node), 1);
+            }
+            node = next;
+        }
+        while (_blocks != nullptr) {
+            Block* next = _blocks->next;
+            NodeAllocTraits::deallocate(_node_alloc, reinterpret_cast<Node*>(_blocks),
+                                        _blocks->slots);
+            _blocks = next;
+        }
+        _free_nodes = nullptr;
+        _fake_node.next = &_fake_node;
+        _fake_node.prev = &_fake_node;
+        _size = 0;
+    }
+
+    template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    void assign(InputIt first, InputIt last) {
+        iterator it = begin();
+        for (; it != end() && first != last; ++it, ++first) {
+            *it = *first;
+        }
+        if (first == last) {
+            while (it != end()) {
+                it = erase(it);
+            }
+        } else {
+            appendRange(first, last);
+        }
+    }
+
+    void assign(size_t count, const T& value) {
+        iterator it = begin();
+        for (; it != end() && count > 0; ++it, --count) {
+            *it = value;
+        }
+        while (it != end()) {
+            it = erase(it);
+        }
+        appendBatch(count, [&](Node* node, BaseNode* next, BaseNode* prev) {
+            NodeAllocTraits::construct(_node_alloc, node, next, prev, value);
+        });
+    }
+
     List(const NodeAlloc& alloc = Alloc())
         : _size(0), _node_alloc(alloc) {}
 
     List(size_t count, const NodeAlloc& alloc = Alloc())
         : _size(0), _node_alloc(alloc) {
-        size_t created = 0;
-
-        try {
-            for (; created < count; ++created) {
-                insert(end());
-            }
-        } catch (...) {
-            for (size_t i = 0; i < created; ++i) {
-                pop_back();
-            }
-            throw;
-        }
+        appendBatch(count, [&](Node* node, BaseNode* next, BaseNode* prev) {
+            NodeAllocTraits::construct(_node_alloc, node, next, prev);
+        });
     }
 
     List(size_t count, const T& value, const NodeAlloc& alloc = Alloc())
         : _size(0), _node_alloc(alloc) {
-        size_t created = 0;
+        appendBatch(count, [&](Node* node, BaseNode* next, BaseNode* prev) {
+            NodeAllocTraits::construct(_node_alloc, node, next, prev, value);
+        });
+    }
 
+    template <typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    List(InputIt first, InputIt last, const NodeAlloc& alloc = Alloc())
+        : _size(0), _node_alloc(alloc) {
         try {
-            for (; created < count; ++created) {
-                push_back(value);
-            }
+            appendRange(first, last);
         } catch (...) {
-            for (size_t i = 0; i < created; ++i) {
-                pop_back();
-            }
+            clear();
             throw;
         }
     }
 
     List(const List& other)
-        : _size(0) {
-        _node_alloc = NodeAllocTraits::select_on_container_copy_construction(other._node_alloc);
-        size_t created = 0;
+        : List(other, NodeAllocTraits::select_on_container_copy_construction(other._node_alloc)) {}
 
-        try {
-            for (const auto& value : other) {
-                push_back(value);
-                ++created;
-            }
-        } catch (...) {
-            for (size_t i = 0; i < created; ++i) {
-                pop_back();
-            }
-            throw;
-        }
+    List(const List& other, const NodeAlloc& alloc)
+        : _size(0), _node_alloc(alloc) {
+        const BaseNode* source = other._fake_node.next;
+        appendBatch(other.size(), [&](Node* node, BaseNode* next, BaseNode* prev) {
+            NodeAllocTraits::construct(_node_alloc, node, next, prev,
+                                       static_cast<const Node*>(source)->value);
+            source = source->next;
+        });
     }
 
     List& operator=(const List& other) {
@@ -266,7 +455,9 @@ class List {
             return *this;
         }
 
-        List<T, Alloc> copy(other);
+        List<T, Alloc> copy(other, NodeAllocTraits::propagate_on_container_copy_assignment::value
+                                       ? other._node_alloc
+                                       : _node_alloc);
         if (size() == 0) {
             _fake_node.next = copy._fake_node.next;
             _fake_node.prev = copy._fake_node.prev;
@@ -288,8 +479,10 @@ class List {
         } else {
             swap(copy);
         }
-        if (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
-            _node_alloc = other._node_alloc;
+        std::swap(_blocks, copy._blocks);
+        std::swap(_free_nodes, copy._free_nodes);
+        if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+            std::swap(_node_alloc, copy._node_alloc);
         }
         return *this;
     }
@@ -299,8 +492,6 @@ class List {
     }
 
     ~List() {
-        while (!empty()) {
-            pop_back();
-        }
+        clear();
     }
 };
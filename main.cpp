@@ -1,15 +1,53 @@
 #include <iostream>
 #include "string.cpp"
+#include "unicode.cpp"
+#include "rope.cpp"
+#include "aho_corasick.cpp"
 #include "biginteger.cpp"
+#include "biginteger_batch.cpp"
 #include "deque.h"
 #include "list.h"
 #include "stack_allocator.h"
+#include "concurrent_list.h"
+#include "fast_io.h"
+#include "fixed_biginteger.h"
+#include "intern_table.h"
+#include "tracing_allocator.h"
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 void SampleString() {
     String s(10, 's');
     cout << s + String("abacaba") << '\n';
 }
 
+void SampleUnicode() {
+    String s("Stra\xc3\x9f" "e");
+    cout << s.is_valid_utf8() << ' ' << s.to_utf32().size() << ' ' << s.to_upper() << ' '
+         << s.find_ignore_case("RA") << '\n';
+}
+
+void SampleRope() {
+    Rope r("hello world");
+    r.insert(5, ",");
+    r += "!";
+    r.erase(0, 1);
+    r.insert(0, "H");
+    cout << r << ' ' << r.flat().size() << '\n';
+}
+
+void SampleSearch() {
+    String record("GET /index.html 200;POST /login 403;GET /admin 403");
+    AhoCorasick keywords{"admin", "login", "403"};
+    for (StringView entry : record.split(";")) {
+        cout << entry << ':';
+        keywords.scan(entry, [](const AhoCorasick::Match& match) { cout << ' ' << match.pattern; });
+        cout << '\n';
+    }
+}
+
 void SampleBigInt() {
     BigInteger a = 2024;
     for (int i = 0; i < 100; ++i) {
@@ -17,6 +55,60 @@ void SampleBigInt() {
     }
     cout << a << '\n';
 }
+void SamplePowMod() {
+    BigInteger p = "170141183460469231731687303715884105727"_bi;
+    cout << powmod(3, p - 1, p) << ' ' << powmod(2, 100, 1000000) << '\n';
+}
+
+void SampleRoots() {
+    cout << isqrt(pow(BigInteger(10), 41)) << ' ' << iroot(factorial(30), 5) << ' ' << binomial(100, 50)
+         << '\n';
+}
+
+void SampleBatch() {
+    std::vector<BigInteger> a = {1, -2, "123456789123456789"_bi};
+    std::vector<BigInteger> b = {-1, -3, 10};
+    BigIntegerColumn sum;
+    BigIntegerColumn product;
+    batchAdd(BigIntegerColumn(a), BigIntegerColumn(b), sum);
+    batchMultiply(BigIntegerColumn(a), BigIntegerColumn(b), product);
+    for (size_t i = 0; i < a.size(); ++i) {
+        cout << sum.get(i) << ' ' << product.get(i) << ' ';
+    }
+    cout << '\n';
+}
+
+void SampleDecimal() {
+    Decimal total = "19.99"_dec * 3 + "0.5"_dec - "5.00"_dec;
+    Decimal third;
+    cout << total << ' ' << (total == "55.47"_dec) << ' ' << Decimal::divide(total, 7, 4) << ' '
+         << Decimal::fromRational(total.toRational() / 3, third) << '\n';
+}
+
+void SampleInterning() {
+    InternTable<BigInteger> table;
+    const BigInteger* a = table.intern(factorial(50));
+    const BigInteger* b = table.intern(factorial(51) / 51);
+    std::unordered_set<Rational> fractions = {Rational(1) / 2, Rational(2) / 4, Rational(-1) / 3};
+    cout << (a == b) << ' ' << table.size() << ' ' << fractions.size() << '\n';
+}
+
+void SampleParallelBigInt() {
+    BigInteger::setThreadCount(std::thread::hardware_concurrency());
+    BigInteger x = 7;
+    for (int i = 0; i < 16; ++i) {
+        x *= x;
+    }
+    cout << x.toString().size() << ' ' << (x * x / x == x) << '\n';
+    BigInteger::setThreadCount(1);
+}
+
+void SampleFixedBigInt() {
+    constexpr Int256 a = Int256(170141183460469231731687303715884105727_fbi) * 3 - 1;
+    static_assert(a % 1000 == 180, "");
+    cout << a << ' ' << (Int256(BigInteger(-5)) / 2).toBigInteger() << '\n';
+}
+
 void SampleDeque() {
     Deque<int> d;
     d.push_back(1);
@@ -44,9 +136,106 @@ void SampleList() {
     cout << '\n';
 }
 
+// Copying fails once copies_left reaches zero; negative means never.
+struct ThrowingCopy {
+    static inline int copies_left = -1;
+    int value;
+
+    ThrowingCopy(int val) : value(val) {}
+    ThrowingCopy(const ThrowingCopy& other) : value(other.value) {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        if (copies_left > 0) {
+            --copies_left;
+        }
+    }
+    ThrowingCopy& operator=(const ThrowingCopy& other) = default;
+};
+
+// A bulk assign that throws halfway must leave the list and its pool of
+// erased nodes usable.
+void SampleListThrowingCopy() {
+    List<ThrowingCopy> l(5, ThrowingCopy(1));
+    for (int i = 0; i < 5; ++i) {
+        l.pop_back();
+    }
+    ThrowingCopy::copies_left = 2;
+    try {
+        l.assign(3, ThrowingCopy(2));
+    } catch (const std::runtime_error& error) {
+        cout << error.what() << ' ';
+    }
+    ThrowingCopy::copies_left = -1;
+    for (int i = 0; i < 6; ++i) {
+        l.push_back(ThrowingCopy(i));
+    }
+    int sum = 0;
+    for (const auto& el : l) {
+        sum += el.value;
+    }
+    cout << l.size() << ' ' << sum << '\n';
+}
+
+void SampleTracing() {
+    AllocationStats stats;
+    TracingAllocator<int> alloc(stats);
+    TracingResource resource(stats);
+    {
+        List<int, TracingAllocator<int>> l(5, 1, alloc);
+        Deque<int, TracingAllocator<int>> d(100, 2, alloc);
+        String s(100, 's', &resource);
+        l.push_back(static_cast<int>(d.size() + s.size()));
+    }
+    cout << stats.toJson() << '\n';
+}
+
+void SampleConcurrentList() {
+    ConcurrentList<int> l;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&l, t] {
+            for (int i = t; i < 40; i += 4) {
+                l.insert(i);
+            }
+            l.erase(t * 10);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    l.for_each([](int el) { cout << el << ' '; });
+    cout << '\n';
+}
+
+void SampleFastIO() {
+    FastWriter out;
+    out << String("2^64 = ") << "18446744073709551616"_bi << '\n';
+    BigInteger x = -"18446744073709551616"_bi;
+    std::vector<char> record(x.serializedSize());
+    x.serialize(record.data());
+    BigInteger y;
+    BigInteger::deserialize(record.data(), record.size(), y);
+    out << ((y >> 60) ^ 5) << ' ' << (y & 0xffff) << ' ' << y.bitLength() << '\n';
+}
+
 int main() {
     SampleString();
+    SampleUnicode();
+    SampleRope();
+    SampleSearch();
     SampleBigInt();
+    SamplePowMod();
+    SampleRoots();
+    SampleBatch();
+    SampleDecimal();
+    SampleInterning();
+    SampleParallelBigInt();
+    SampleFixedBigInt();
     SampleDeque();
     SampleList();
+    SampleListThrowingCopy();
+    SampleTracing();
+    SampleConcurrentList();
+    SampleFastIO();
 }
@@ -0,0 +1,259 @@
+#include "rope.h"
+#include <algorithm>
+#include <cstring>
+
+const size_t Rope::MAX_PIECE;
+
+Rope::Node::Node(const StringView& text, uint32_t prio)
+    : piece(text), length(text.size()), priority(prio) {}
+
+uint32_t Rope::random_priority() {
+    thread_local uint32_t state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+size_t Rope::length(const Node* node) {
+    return (node == nullptr ? 0 : node->length);
+}
+
+void Rope::update(Node* node) {
+    node->length = length(node->left) + node->piece.size() + length(node->right);
+}
+
+Rope::Node* Rope::merge(Node* left, Node* right) {
+    if (left == nullptr) {
+        return right;
+    }
+    if (right == nullptr) {
+        return left;
+    }
+    if (left->priority >= right->priority) {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+// Splits off the first `pos` characters; a piece that straddles the
+// boundary is cut in two.
+void Rope::split(Node* node, size_t pos, Node*& left, Node*& right) {
+    if (node == nullptr) {
+        left = right = nullptr;
+        return;
+    }
+    size_t left_length = length(node->left);
+    size_t piece_length = node->piece.size();
+    if (pos <= left_length) {
+        split(node->left, pos, left, node->left);
+        update(node);
+        right = node;
+    } else if (pos >= left_length + piece_length) {
+        split(node->right, pos - left_length - piece_length, node->right, right);
+        update(node);
+        left = node;
+    } else {
+        size_t cut = pos - left_length;
+        Node* tail = new Node(node->piece.view(cut, piece_length - cut), node->priority);
+        tail->right = node->right;
+        update(tail);
+        node->piece.resize(cut);
+        node->right = nullptr;
+        update(node);
+        left = node;
+        right = tail;
+    }
+}
+
+Rope::Node* Rope::build(const StringView& text) {
+    Node* result = nullptr;
+    for (size_t pos = 0; pos < text.size(); pos += MAX_PIECE) {
+        size_t count = std::min(MAX_PIECE, text.size() - pos);
+        result = merge(result, new Node(text.substr(pos, count), random_priority()));
+    }
+    return result;
+}
+
+// Small appends go into the last piece while it has room, so repeated
+// short concatenations don't produce a node per call.
+Rope::Node* Rope::append(Node* node, const StringView& text) {
+    if (text.empty()) {
+        return node;
+    }
+    Node* last = node;
+    while (last != nullptr && last->right != nullptr) {
+        last = last->right;
+    }
+    if (last == nullptr || last->piece.size() + text.size() > MAX_PIECE) {
+        return merge(node, build(text));
+    }
+    last->piece.append(text.data(), text.size());
+    for (Node* cur = node; cur != nullptr; cur = cur->right) {
+        cur->length += text.size();
+    }
+    return node;
+}
+
+Rope::Node* Rope::copy(const Node* node) {
+    if (node == nullptr) {
+        return nullptr;
+    }
+    Node* result = new Node(StringView(node->piece), node->priority);
+    result->left = copy(node->left);
+    result->right = copy(node->right);
+    result->length = node->length;
+    return result;
+}
+
+void Rope::destroy(Node* node) {
+    while (node != nullptr) {
+        destroy(node->left);
+        Node* right = node->right;
+        delete node;
+        node = right;
+    }
+}
+
+void Rope::invalidate() {
+    if (flat_valid_) {
+        flat_valid_ = false;
+        flat_.clear();
+        flat_.shrink_to_fit();
+    }
+}
+
+Rope::Rope() = default;
+
+Rope::Rope(const StringView& text) : root_(build(text)), flat_valid_(false) {}
+
+Rope::Rope(const Rope& rope) : root_(copy(rope.root_)), flat_valid_(false) {}
+
+Rope::Rope(Rope&& rope) : root_(rope.root_), flat_valid_(false) {
+    rope.root_ = nullptr;
+    rope.invalidate();
+}
+
+Rope& Rope::operator=(Rope rope) {
+    std::swap(root_, rope.root_);
+    invalidate();
+    return *this;
+}
+
+char Rope::operator[](size_t index) const {
+    const Node* node = root_;
+    while (true) {
+        size_t left_length = length(node->left);
+        if (index < left_length) {
+            node = node->left;
+        } else if (index < left_length + node->piece.size()) {
+            return node->piece[index - left_length];
+        } else {
+            index -= left_length + node->piece.size();
+            node = node->right;
+        }
+    }
+}
+
+size_t Rope::length() const {
+    return length(root_);
+}
+
+size_t Rope::size() const {
+    return length(root_);
+}
+
+bool Rope::empty() const {
+    return root_ == nullptr;
+}
+
+void Rope::insert(size_t pos, const StringView& text) {
+    Node* left = nullptr;
+    Node* right = nullptr;
+    split(root_, pos, left, right);
+    root_ = merge(append(left, text), right);
+    invalidate();
+}
+
+void Rope::erase(size_t pos, size_t count) {
+    Node* left = nullptr;
+    Node* middle = nullptr;
+    Node* right = nullptr;
+    split(root_, pos, left, right);
+    split(right, count, middle, right);
+    destroy(middle);
+    root_ = merge(left, right);
+    invalidate();
+}
+
+Rope& Rope::operator+=(const StringView& text) {
+    root_ = append(root_, text);
+    invalidate();
+    return *this;
+}
+
+Rope& Rope::operator+=(Rope&& rope) {
+    root_ = merge(root_, rope.root_);
+    rope.root_ = nullptr;
+    rope.invalidate();
+    invalidate();
+    return *this;
+}
+
+Rope& Rope::operator+=(const Rope& rope) {
+    return *this += Rope(rope);
+}
+
+Rope Rope::substr(size_t start, size_t count) const {
+    Rope result;
+    for_each_chunk([&](const StringView& chunk) {
+        if (count == 0) {
+            return;
+        }
+        if (start >= chunk.size()) {
+            start -= chunk.size();
+            return;
+        }
+        size_t taken = std::min(count, chunk.size() - start);
+        result += chunk.substr(start, taken);
+        start = 0;
+        count -= taken;
+    });
+    return result;
+}
+
+const String& Rope::flat() const {
+    if (!flat_valid_) {
+        flat_ = String(size(), '\0');
+        char* dest = flat_.data();
+        for_each_chunk([&dest](const StringView& chunk) {
+            memcpy(dest, chunk.data(), chunk.size());
+            dest += chunk.size();
+        });
+        flat_valid_ = true;
+    }
+    return flat_;
+}
+
+Rope::~Rope() {
+    destroy(root_);
+}
+
+std::ostream& operator<<(std::ostream& out, const Rope& rope) {
+    rope.for_each_chunk([&out](const StringView& chunk) { out << chunk; });
+    return out;
+}
+
+Rope operator+(Rope a, Rope&& b) {
+    a += std::move(b);
+    return a;
+}
+
+Rope operator+(Rope a, const Rope& b) {
+    a += b;
+    return a;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include "string.h"
+
+// Text as a treap of String pieces ordered by position. Concatenation,
+// insertion, erasure and indexing take O(log n) expected time; flat()
+// builds a contiguous String on demand and keeps it until the next edit.
+class Rope {
+  private:
+    static const size_t MAX_PIECE = 1024;
+
+    struct Node {
+        String piece;
+        size_t length;
+        uint32_t priority;
+        Node* left = nullptr;
+        Node* right = nullptr;
+
+        Node(const StringView& text, uint32_t prio);
+    };
+
+    Node* root_ = nullptr;
+    mutable String flat_;
+    mutable bool flat_valid_ = true;
+
+    static uint32_t random_priority();
+    static size_t length(const Node* node);
+    static void update(Node* node);
+    static Node* merge(Node* left, Node* right);
+    static void split(Node* node, size_t pos, Node*& left, Node*& right);
+    static Node* build(const StringView& text);
+    static Node* append(Node* node, const StringView& text);
+    static Node* copy(const Node* node);
+    static void destroy(Node* node);
+    template <typename Func>
+    static void visit(const Node* node, Func& func);
+    void invalidate();
+
+  public:
+    Rope();
+    Rope(const StringView& text);
+    Rope(const Rope& rope);
+    Rope(Rope&& rope);
+    Rope& operator=(Rope rope);
+    char operator[](size_t index) const;
+    size_t length() const;
+    size_t size() const;
+    bool empty() const;
+    void insert(size_t pos, const StringView& text);
+    void erase(size_t pos, size_t count);
+    Rope& operator+=(const StringView& text);
+    Rope& operator+=(Rope&& rope);
+    Rope& operator+=(const Rope& rope);
+    Rope substr(size_t start, size_t count) const;
+    const String& flat() const;
+    template <typename Func>
+    void for_each_chunk(Func func) const;
+    ~Rope();
+};
+
+std::ostream& operator<<(std::ostream& out, const Rope& rope);
+
+Rope operator+(Rope a, Rope&& b);
+
+Rope operator+(Rope a, const Rope& b);
+
+template <typename Func>
+void Rope::visit(const Node* node, Func& func) {
+    while (node != nullptr) {
+        visit(node->left, func);
+        func(StringView(node->piece));
+        node = node->right;
+    }
+}
+
+template <typename Func>
+void Rope::for_each_chunk(Func func) const {
+    visit(root_, func);
+}
@@ -1,76 +1,508 @@
 #pragma once
+#include <algorithm>
 #include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <thread>
+#include <tuple>
 
+enum class StorageGrowth { FIXED, CHAINED };
+
+// Bump-pointer arena over an inline buffer of N bytes. In CHAINED mode an
+// exhausted buffer is followed by blocks taken from `upstream`, each twice
+// as large as the previous one; they are given back on destruction.
+// Released memory is reclaimed: the most recent allocation simply moves
+// the bump pointer back, anything else up to MAX_CLASS_SIZE bytes goes to
+// a free list per 8-byte size class and is handed out again by reserve.
+// Such small sizes are rounded up to their class on both reserve and
+// release, so a freed block fits every later request of its class.
+// mark()/rollback() discard everything allocated after the mark at once;
+// chained blocks freed this way are kept for reuse instead of returned.
 template <int N>
 class StackStorage {
+  private:
+    struct Block;
+
   public:
-    StackStorage()
-        : _size(N), _ptr(_storage) {}
+    class Mark {
+      private:
+        Block* _block;
+        void* _ptr;
+        size_t _size;
+        size_t _in_use;
+
+        Mark(Block* block, void* ptr, size_t size, size_t in_use)
+            : _block(block), _ptr(ptr), _size(size), _in_use(in_use) {}
+        friend StackStorage;
+    };
+
+    class ScopedMark {
+      public:
+        explicit ScopedMark(StackStorage& storage)
+            : _storage(storage), _mark(storage.mark()) {}
+        ScopedMark(const ScopedMark& other) = delete;
+        ScopedMark& operator=(const ScopedMark& other) = delete;
+        ~ScopedMark() {
+            _storage.rollback(_mark);
+        }
+
+      private:
+        StackStorage& _storage;
+        Mark _mark;
+    };
+
+    StackStorage(StorageGrowth growth = StorageGrowth::FIXED,
+                 std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : _size(N), _ptr(_storage), _growth(growth), _upstream(upstream) {}
     StackStorage(const StackStorage<N>& other) = delete;
 
+    ~StackStorage() {
+        freeBlocks(_block);
+        freeBlocks(_spare);
+    }
+
+    void* reserveBytes(size_t bytes, size_t alignment) {
+        size_t size = classBytes(bytes);
+        size_t size_class = size / CLASS_GRANULARITY;
+        if (size_class < SIZE_CLASSES && _free_lists[size_class] != nullptr &&
+            reinterpret_cast<uintptr_t>(_free_lists[size_class]) % alignment == 0) {
+            FreeBlock* block = _free_lists[size_class];
+            _free_lists[size_class] = block->next;
+            use(bytes);
+            return block;
+        }
+        if (std::align(alignment, size, _ptr, _size) == nullptr) {
+            if (_growth == StorageGrowth::FIXED) {
+                return nullptr;
+            }
+            if (size > SIZE_MAX - alignment - sizeof(Block)) {
+                throw std::bad_alloc();
+            }
+            grow(size + alignment);
+            if (std::align(alignment, size, _ptr, _size) == nullptr) {
+                throw std::bad_alloc();
+            }
+        }
+        void* res = _ptr;
+        _ptr = reinterpret_cast<char*>(_ptr) + size;
+        _size -= size;
+        use(bytes);
+        return res;
+    }
+
     template <typename T>
     T* reserve(size_t count) {
-        size_t bytes = sizeof(T) * count;
-        if (std::align(alignof(T), bytes, _ptr, _size)) {
-            T* res = reinterpret_cast<T*>(_ptr);
-            _ptr = reinterpret_cast<char*>(_ptr) + bytes;
-            _size -= bytes;
-            return res;
+        if (count > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(reserveBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    void releaseBytes(void* ptr, size_t bytes) {
+        _in_use -= std::min(bytes, _in_use);
+        size_t size = classBytes(bytes);
+        if (reinterpret_cast<char*>(ptr) + size == _ptr) {
+            _ptr = ptr;
+            _size += size;
+            return;
+        }
+        size_t size_class = size / CLASS_GRANULARITY;
+        if (size >= sizeof(FreeBlock) && size_class < SIZE_CLASSES &&
+            reinterpret_cast<uintptr_t>(ptr) % alignof(FreeBlock) == 0) {
+            _free_lists[size_class] = new (ptr) FreeBlock{_free_lists[size_class]};
+        }
+    }
+
+    template <typename T>
+    void release(T* ptr, size_t count) {
+        releaseBytes(ptr, sizeof(T) * count);
+    }
+
+    Mark mark() const {
+        return Mark(_block, _ptr, _size, _in_use);
+    }
+
+    // Frees everything reserved after `mark` in O(1) per chained block.
+    // Free lists are dropped as well, including blocks released before
+    // the mark.
+    void rollback(const Mark& mark) {
+        while (_block != mark._block) {
+            Block* prev = _block->prev;
+            _block->prev = _spare;
+            _spare = _block;
+            _block = prev;
+        }
+        _ptr = mark._ptr;
+        _size = mark._size;
+        _in_use = mark._in_use;
+        std::fill(std::begin(_free_lists), std::end(_free_lists), nullptr);
+    }
+
+    void reset() {
+        rollback(Mark(nullptr, _storage, N, 0));
+    }
+
+    size_t bytesInUse() const {
+        return _in_use;
+    }
+
+    size_t highWaterMark() const {
+        return _high_water;
+    }
+
+    bool owns(const void* ptr) const {
+        auto inside = [ptr](const void* begin, size_t bytes) {
+            std::less_equal<const void*> before;
+            return before(begin, ptr) && !before(static_cast<const char*>(begin) + bytes, ptr);
+        };
+        if (inside(_storage, N)) {
+            return true;
+        }
+        for (Block* block = _block; block != nullptr; block = block->prev) {
+            if (inside(block + 1, block->capacity)) {
+                return true;
+            }
         }
-        return nullptr;
+        return false;
     }
 
   private:
+    static const size_t CLASS_GRANULARITY = 8;
+    static const size_t MAX_CLASS_SIZE = 256;
+    static const size_t SIZE_CLASSES = MAX_CLASS_SIZE / CLASS_GRANULARITY + 1;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(std::max_align_t) Block {
+        Block* prev;
+        size_t capacity;
+    };
+
+    static size_t classBytes(size_t bytes) {
+        if (bytes > MAX_CLASS_SIZE) {
+            return bytes;
+        }
+        return (bytes + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY * CLASS_GRANULARITY;
+    }
+
+    void use(size_t bytes) {
+        _in_use += bytes;
+        _high_water = std::max(_high_water, _in_use);
+    }
+
+    void freeBlocks(Block* block) {
+        while (block != nullptr) {
+            Block* prev = block->prev;
+            _upstream->deallocate(block, sizeof(Block) + block->capacity,
+                                  alignof(std::max_align_t));
+            block = prev;
+        }
+    }
+
+    void grow(size_t min_bytes) {
+        if (_spare != nullptr && _spare->capacity >= min_bytes) {
+            Block* block = _spare;
+            _spare = block->prev;
+            block->prev = _block;
+            _block = block;
+            _ptr = reinterpret_cast<char*>(block) + sizeof(Block);
+            _size = block->capacity;
+            return;
+        }
+        size_t capacity = std::max(_next_block_size, min_bytes);
+        void* memory = _upstream->allocate(sizeof(Block) + capacity, alignof(std::max_align_t));
+        _block = new (memory) Block{_block, capacity};
+        _next_block_size = capacity * 2;
+        _ptr = reinterpret_cast<char*>(memory) + sizeof(Block);
+        _size = capacity;
+    }
+
     char _storage[N]{};
     size_t _size;
     void* _ptr;
+    StorageGrowth _growth;
+    std::pmr::memory_resource* _upstream;
+    Block* _block = nullptr;
+    size_t _next_block_size = std::max(2 * static_cast<size_t>(N), sizeof(Block));
+    FreeBlock* _free_lists[SIZE_CLASSES]{};
+    Block* _spare = nullptr;
+    size_t _in_use = 0;
+    size_t _high_water = 0;
+};
+
+// Fixed arena shared by several threads: reserve bumps an atomic offset
+// with a CAS loop, release only takes back the most recent allocation.
+// bytesInUse() counts live bytes, which can be well below bytesReserved(),
+// the bump offset, once memory that is not on top has been released.
+template <int N>
+class ConcurrentStackStorage {
+  public:
+    ConcurrentStackStorage() = default;
+    ConcurrentStackStorage(const ConcurrentStackStorage<N>& other) = delete;
+
+    void* reserveBytes(size_t bytes, size_t alignment) {
+        size_t offset = _offset.load(std::memory_order_relaxed);
+        while (true) {
+            uintptr_t start = reinterpret_cast<uintptr_t>(_storage) + offset;
+            size_t aligned = offset + (alignment - start % alignment) % alignment;
+            if (aligned > static_cast<size_t>(N) || bytes > N - aligned) {
+                return nullptr;
+            }
+            if (_offset.compare_exchange_weak(offset, aligned + bytes, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+                _in_use.fetch_add(bytes, std::memory_order_relaxed);
+                return _storage + aligned;
+            }
+        }
+    }
+
+    template <typename T>
+    T* reserve(size_t count) {
+        if (count > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(reserveBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    void releaseBytes(void* ptr, size_t bytes) {
+        size_t begin = static_cast<size_t>(static_cast<char*>(ptr) - _storage);
+        size_t end = begin + bytes;
+        _in_use.fetch_sub(bytes, std::memory_order_relaxed);
+        _offset.compare_exchange_strong(end, begin, std::memory_order_acq_rel,
+                                        std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void release(T* ptr, size_t count) {
+        releaseBytes(ptr, sizeof(T) * count);
+    }
+
+    size_t bytesInUse() const {
+        return _in_use.load(std::memory_order_relaxed);
+    }
+
+    size_t bytesReserved() const {
+        return _offset.load(std::memory_order_relaxed);
+    }
+
+  private:
+    alignas(std::max_align_t) char _storage[N]{};
+    std::atomic<size_t> _offset{0};
+    std::atomic<size_t> _in_use{0};
+};
+
+// One StackStorage<N> per thread behind a single handle. Each thread
+// reserves from its own arena without synchronization; memory released
+// by another thread is pushed onto the owner's lock-free remote list and
+// reclaimed by the owner on its next reserve. Per-thread arenas are fixed
+// size so that ownership can be decided by address.
+template <int N>
+class ThreadLocalStackStorage {
+  public:
+    ThreadLocalStackStorage()
+        : _id(_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+    ThreadLocalStackStorage(const ThreadLocalStackStorage<N>& other) = delete;
+
+    ~ThreadLocalStackStorage() {
+        Arena* arena = _arenas.load(std::memory_order_acquire);
+        while (arena != nullptr) {
+            Arena* next = arena->next;
+            delete arena;
+            arena = next;
+        }
+    }
+
+    void* reserveBytes(size_t bytes, size_t alignment) {
+        Arena& arena = localArena();
+        if (arena.remote.load(std::memory_order_relaxed) != nullptr) {
+            RemoteFree* node = arena.remote.exchange(nullptr, std::memory_order_acquire);
+            while (node != nullptr) {
+                RemoteFree* next = node->next;
+                arena.storage.releaseBytes(node, node->bytes);
+                node = next;
+            }
+        }
+        return arena.storage.reserveBytes(std::max(bytes, sizeof(RemoteFree)),
+                                          std::max(alignment, alignof(RemoteFree)));
+    }
+
+    template <typename T>
+    T* reserve(size_t count) {
+        if (count > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(reserveBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    // A thread that only releases, such as a consumer freeing a
+    // producer's memory, never gets an arena of its own.
+    void releaseBytes(void* ptr, size_t bytes) {
+        bytes = std::max(bytes, sizeof(RemoteFree));
+        Arena* local = findArena();
+        if (local != nullptr && local->storage.owns(ptr)) {
+            local->storage.releaseBytes(ptr, bytes);
+            return;
+        }
+        for (Arena* owner = _arenas.load(std::memory_order_acquire); owner != nullptr;
+             owner = owner->next) {
+            if (owner != local && owner->storage.owns(ptr)) {
+                RemoteFree* node = new (ptr) RemoteFree{owner->remote.load(std::memory_order_relaxed), bytes};
+                while (!owner->remote.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                            std::memory_order_relaxed)) {
+                }
+                return;
+            }
+        }
+    }
+
+    template <typename T>
+    void release(T* ptr, size_t count) {
+        releaseBytes(ptr, sizeof(T) * count);
+    }
+
+  private:
+    struct RemoteFree {
+        RemoteFree* next;
+        size_t bytes;
+    };
+
+    struct Arena {
+        StackStorage<N> storage;
+        std::thread::id owner;
+        std::atomic<RemoteFree*> remote{nullptr};
+        Arena* next = nullptr;
+
+        explicit Arena(std::thread::id thread)
+            : owner(thread) {}
+    };
+
+    // The calling thread's arena, or nullptr if it has none yet.
+    Arena* findArena() {
+        if (_cached_id == _id) {
+            return _cached_arena;
+        }
+        std::thread::id self = std::this_thread::get_id();
+        Arena* arena = _arenas.load(std::memory_order_acquire);
+        while (arena != nullptr && arena->owner != self) {
+            arena = arena->next;
+        }
+        if (arena != nullptr) {
+            _cached_id = _id;
+            _cached_arena = arena;
+        }
+        return arena;
+    }
+
+    Arena& localArena() {
+        Arena* arena = findArena();
+        if (arena == nullptr) {
+            arena = new Arena(std::this_thread::get_id());
+            arena->next = _arenas.load(std::memory_order_relaxed);
+            while (!_arenas.compare_exchange_weak(arena->next, arena, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            }
+            _cached_id = _id;
+            _cached_arena = arena;
+        }
+        return *arena;
+    }
+
+    static inline std::atomic<uint64_t> _next_id{1};
+    static inline thread_local uint64_t _cached_id = 0;
+    static inline thread_local Arena* _cached_arena = nullptr;
+
+    uint64_t _id;
+    std::atomic<Arena*> _arenas{nullptr};
 };
 
-template <typename T, int N>
+template <typename T, int N, typename Storage = StackStorage<N>>
 class StackAllocator {
   public:
     using value_type = T;
 
     StackAllocator()
         : _pool(nullptr) {}
-    StackAllocator(StackStorage<N>& tmp_pool)
+    StackAllocator(Storage& tmp_pool)
         : _pool(&tmp_pool) {}
     template <typename U>
-    StackAllocator(const StackAllocator<U, N>& other) {
+    StackAllocator(const StackAllocator<U, N, Storage>& other) {
         _pool = other.getPool();
     };
-    StackAllocator& operator=(const StackAllocator<T, N>& other) = default;
+    StackAllocator& operator=(const StackAllocator<T, N, Storage>& other) = default;
     ~StackAllocator() = default;
 
-    bool operator==(const StackAllocator<T, N>& other) {
+    bool operator==(const StackAllocator<T, N, Storage>& other) const {
         return _pool == other.getPool();
     }
-    bool operator!=(const StackAllocator<T, N>& other) {
+    bool operator!=(const StackAllocator<T, N, Storage>& other) const {
         return !(operator==(other));
     }
 
     T* allocate(size_t count) {
-        return _pool->template reserve<T>(count);
+        T* res = _pool->template reserve<T>(count);
+        if (res == nullptr) {
+            throw std::bad_alloc();
+        }
+        return res;
     }
 
     void deallocate(T* ptr, size_t count) {
-        std::ignore = ptr;
-        std::ignore = count;
+        _pool->release(ptr, count);
     }
 
-    StackStorage<N>* getPool() const {
+    Storage* getPool() const {
         return _pool;
     }
 
     template <typename U>
     struct rebind {
-        using other = StackAllocator<U, N>;
+        using other = StackAllocator<U, N, Storage>;
     };
 
   private:
-    StackStorage<N>* _pool;
+    Storage* _pool;
     size_t _alignment{};
     size_t _size_of{};
 };
+
+// std::pmr adapter: lets any pmr-aware container allocate from a stack
+// storage without carrying N in its allocator type. Chained storages take
+// an upstream resource of their own, so resources can be stacked.
+template <int N, typename Storage = StackStorage<N>>
+class StackMemoryResource : public std::pmr::memory_resource {
+  public:
+    StackMemoryResource(Storage& tmp_pool)
+        : _pool(&tmp_pool) {}
+
+    Storage* getPool() const {
+        return _pool;
+    }
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* res = _pool->reserveBytes(bytes, alignment);
+        if (res == nullptr) {
+            throw std::bad_alloc();
+        }
+        return res;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        std::ignore = alignment;
+        _pool->releaseBytes(ptr, bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto* resource = dynamic_cast<const StackMemoryResource*>(&other);
+        return resource != nullptr && resource->_pool == _pool;
+    }
+
+    Storage* _pool;
+};
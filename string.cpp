@@ -1,77 +1,389 @@
 #include "string.h"
+#include "unicode.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STRING_SEARCH_X86
+#include <immintrin.h>
+#endif
 using std::cout, std::cin;
 
-String::String(int count)
-    : size_(count), capacity_(count), array_(new char[count + 1]) {
-    array_[size_] = '\0';
-}
+namespace {
 
-void String::swap(String& str) {
-    std::swap(array_, str.array_);
-    std::swap(size_, str.size_);
-    std::swap(capacity_, str.capacity_);
+const size_t NOT_FOUND = SIZE_MAX;
+const size_t LONG_NEEDLE = 32;
+
+using SearchFunction = size_t (*)(const char*, size_t, const char*, size_t);
+
+bool middle_matches(const char* candidate, const char* needle, size_t m) {
+    return m <= 2 || memcmp(candidate + 1, needle + 1, m - 2) == 0;
 }
 
-void String::change_capacity(size_t new_capacity) {
-    capacity_ = std::max(1, static_cast<int>(new_capacity));
-    char* new_arrays = new char[capacity_ + 1];
-    memcpy(new_arrays, array_, size_ + 1);
-    delete[] array_;
-    array_ = new_arrays;
+// Candidates are filtered by comparing the needle's first and last bytes
+// against the haystack; only positions where both match are checked fully.
+size_t find_scalar(const char* haystack, size_t n, const char* needle, size_t m,
+                   size_t from) {
+    for (size_t i = from; i + m <= n; ++i) {
+        if (haystack[i] == needle[0] && haystack[i + m - 1] == needle[m - 1] &&
+            middle_matches(haystack + i, needle, m)) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
 }
 
-bool String::check(char* str_begin, const char* str_end, char* substr_begin) {
-    while (str_begin != str_end) {
-        if (*str_begin != *substr_begin) {
-            return false;
+size_t rfind_scalar(const char* haystack, const char* needle, size_t m, size_t to) {
+    for (size_t i = to; i > 0; --i) {
+        const char* candidate = haystack + i - 1;
+        if (candidate[0] == needle[0] && candidate[m - 1] == needle[m - 1] &&
+            middle_matches(candidate, needle, m)) {
+            return i - 1;
+        }
+    }
+    return NOT_FOUND;
+}
+
+#ifndef STRING_SEARCH_X86
+size_t find_generic(const char* haystack, size_t n, const char* needle, size_t m) {
+    return find_scalar(haystack, n, needle, m, 0);
+}
+
+size_t rfind_generic(const char* haystack, size_t n, const char* needle, size_t m) {
+    return rfind_scalar(haystack, needle, m, n - m + 1);
+}
+#else
+#define STRING_SEARCH_KERNELS(TARGET, NAME, VEC, WIDTH, LOAD, SET1, CMPEQ, AND, MOVEMASK)        \
+    __attribute__((target(TARGET))) size_t find_##NAME(const char* haystack, size_t n,     \
+                                                      const char* needle, size_t m) {     \
+        const auto first = SET1(needle[0]);                                               \
+        const auto last = SET1(needle[m - 1]);                                            \
+        size_t i = 0;                                                                     \
+        for (; i + m - 1 + WIDTH <= n; i += WIDTH) {                                      \
+            auto block_first = LOAD(reinterpret_cast<const VEC*>(haystack + i));          \
+            auto block_last = LOAD(reinterpret_cast<const VEC*>(haystack + i + m - 1));   \
+            uint32_t mask = static_cast<uint32_t>(                                        \
+                MOVEMASK(AND(CMPEQ(first, block_first), CMPEQ(last, block_last))));       \
+            while (mask != 0) {                                                           \
+                size_t pos = i + __builtin_ctz(mask);                                     \
+                if (middle_matches(haystack + pos, needle, m)) {                          \
+                    return pos;                                                           \
+                }                                                                         \
+                mask &= mask - 1;                                                         \
+            }                                                                             \
+        }                                                                                 \
+        return find_scalar(haystack, n, needle, m, i);                                    \
+    }                                                                                     \
+                                                                                          \
+    __attribute__((target(TARGET))) size_t rfind_##NAME(const char* haystack, size_t n,    \
+                                                       const char* needle, size_t m) {    \
+        const auto first = SET1(needle[0]);                                               \
+        const auto last = SET1(needle[m - 1]);                                            \
+        size_t end = n - m + 1;                                                           \
+        for (; end >= WIDTH; end -= WIDTH) {                                              \
+            size_t i = end - WIDTH;                                                       \
+            auto block_first = LOAD(reinterpret_cast<const VEC*>(haystack + i));          \
+            auto block_last = LOAD(reinterpret_cast<const VEC*>(haystack + i + m - 1));   \
+            uint32_t mask = static_cast<uint32_t>(                                        \
+                MOVEMASK(AND(CMPEQ(first, block_first), CMPEQ(last, block_last))));       \
+            while (mask != 0) {                                                           \
+                size_t bit = 31 - __builtin_clz(mask);                                    \
+                if (middle_matches(haystack + i + bit, needle, m)) {                      \
+                    return i + bit;                                                       \
+                }                                                                         \
+                mask &= ~(uint32_t(1) << bit);                                            \
+            }                                                                             \
+        }                                                                                 \
+        return rfind_scalar(haystack, needle, m, end);                                    \
+    }
+
+STRING_SEARCH_KERNELS("sse2", sse2, __m128i, 16, _mm_loadu_si128, _mm_set1_epi8, _mm_cmpeq_epi8,
+                      _mm_and_si128, _mm_movemask_epi8)
+STRING_SEARCH_KERNELS("avx2", avx2, __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8,
+                      _mm256_cmpeq_epi8, _mm256_and_si256, _mm256_movemask_epi8)
+#undef STRING_SEARCH_KERNELS
+
+bool has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+SearchFunction select_find() {
+#ifdef STRING_SEARCH_X86
+    return (has_avx2() ? find_avx2 : find_sse2);
+#else
+    return find_generic;
+#endif
+}
+
+SearchFunction select_rfind() {
+#ifdef STRING_SEARCH_X86
+    return (has_avx2() ? rfind_avx2 : rfind_sse2);
+#else
+    return rfind_generic;
+#endif
+}
+
+// Boyer-Moore-Horspool: for long needles the bad-character shift skips
+// most of the haystack without looking at it.
+size_t find_horspool(const char* haystack, size_t n, const char* needle, size_t m) {
+    size_t shift[256];
+    std::fill(shift, shift + 256, m);
+    for (size_t i = 0; i + 1 < m; ++i) {
+        shift[static_cast<unsigned char>(needle[i])] = m - 1 - i;
+    }
+    for (size_t i = 0; i + m <= n;) {
+        unsigned char ch = haystack[i + m - 1];
+        if (ch == static_cast<unsigned char>(needle[m - 1]) &&
+            memcmp(haystack + i, needle, m - 1) == 0) {
+            return i;
         }
-        ++str_begin;
-        ++substr_begin;
+        i += shift[ch];
     }
-    return true;
+    return NOT_FOUND;
 }
 
-size_t String::find(const String& substr, size_t start, size_t stop,
-                    int step) const {
-    for (size_t i = start; i != stop; i += step) {
-        if (check(array_ + i, array_ + i + substr.size_, substr.array_)) {
+size_t rfind_horspool(const char* haystack, size_t n, const char* needle, size_t m) {
+    size_t shift[256];
+    std::fill(shift, shift + 256, m);
+    for (size_t i = m - 1; i > 0; --i) {
+        shift[static_cast<unsigned char>(needle[i])] = i;
+    }
+    size_t i = n - m;
+    while (true) {
+        unsigned char ch = haystack[i];
+        if (ch == static_cast<unsigned char>(needle[0]) &&
+            memcmp(haystack + i + 1, needle + 1, m - 1) == 0) {
             return i;
         }
+        if (i < shift[ch]) {
+            return NOT_FOUND;
+        }
+        i -= shift[ch];
     }
-    return length();
 }
 
-String::String(const char* str)
-    : size_(strlen(str)), capacity_(size_), array_(new char[capacity_ + 1]) {
-    memcpy(array_, str, size_ + 1);
+size_t search_forward(const char* haystack, size_t n, const char* needle, size_t m) {
+    static const SearchFunction find_short = select_find();
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return NOT_FOUND;
+    }
+    return (m >= LONG_NEEDLE ? find_horspool : find_short)(haystack, n, needle, m);
 }
 
-String::String() : String(0){};
+size_t search_backward(const char* haystack, size_t n, const char* needle, size_t m) {
+    static const SearchFunction rfind_short = select_rfind();
+    if (m == 0) {
+        return n;
+    }
+    if (m > n) {
+        return NOT_FOUND;
+    }
+    return (m >= LONG_NEEDLE ? rfind_horspool : rfind_short)(haystack, n, needle, m);
+}
+
+// wyhash (final version 4): 128-bit multiply-and-fold over 16- and
+// 48-byte strides, with overlapping reads for the short tails.
+uint64_t wy_mix(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+uint64_t wy_read8(const char* ptr) {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+uint64_t wy_read4(const char* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+uint64_t hash_bytes(const char* ptr, size_t len, uint64_t seed) {
+    const uint64_t secret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+    seed ^= wy_mix(seed ^ secret[0], secret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t shift = (len >> 3) << 2;
+            a = (wy_read4(ptr) << 32) | wy_read4(ptr + shift);
+            b = (wy_read4(ptr + len - 4) << 32) | wy_read4(ptr + len - 4 - shift);
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(static_cast<unsigned char>(ptr[0])) << 16) |
+                (static_cast<uint64_t>(static_cast<unsigned char>(ptr[len >> 1])) << 8) |
+                static_cast<unsigned char>(ptr[len - 1]);
+        }
+    } else {
+        size_t left = len;
+        if (left > 48) {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do {
+                seed = wy_mix(wy_read8(ptr) ^ secret[1], wy_read8(ptr + 8) ^ seed);
+                seed1 = wy_mix(wy_read8(ptr + 16) ^ secret[2], wy_read8(ptr + 24) ^ seed1);
+                seed2 = wy_mix(wy_read8(ptr + 32) ^ secret[3], wy_read8(ptr + 40) ^ seed2);
+                ptr += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (left > 16) {
+            seed = wy_mix(wy_read8(ptr) ^ secret[1], wy_read8(ptr + 8) ^ seed);
+            ptr += 16;
+            left -= 16;
+        }
+        a = wy_read8(ptr + left - 16);
+        b = wy_read8(ptr + left - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+    return wy_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+}  // namespace
+
+std::atomic<double> String::growth_factor_{2.0};
 
-String::String(size_t n, char ch)
-    : size_(n), capacity_(n), array_(new char[n + 1]) {
-    memset(array_, ch, n);
-    array_[n] = '\0';
+bool String::is_local() const {
+    return !on_heap_;
 }
 
-String::String(const String& str)
-    : size_(str.size_), capacity_(str.size_), array_(new char[str.size_ + 1]) {
-    memcpy(array_, str.array_, size_ + 1);
+void String::allocate(size_t capacity) {
+    if (capacity <= LOCAL_CAPACITY) {
+        on_heap_ = false;
+        return;
+    }
+    heap_.data = static_cast<char*>(resource_->allocate(capacity + 1, 1));
+    heap_.capacity = capacity;
+    on_heap_ = true;
 }
 
-String& String::operator=(String str) {
-    swap(str);
+void String::deallocate() {
+    if (!is_local()) {
+        resource_->deallocate(heap_.data, heap_.capacity + 1, 1);
+    }
+}
+
+void String::swap(String& str) {
+    std::swap(local_, str.local_);
+    size_t old_size = size_;
+    size_ = str.size_;
+    str.size_ = old_size;
+    bool was_on_heap = on_heap_;
+    on_heap_ = str.on_heap_;
+    str.on_heap_ = was_on_heap;
+    std::swap(resource_, str.resource_);
+}
+
+void String::change_capacity(size_t new_capacity) {
+    new_capacity = std::max<size_t>(new_capacity, size_);
+    if (new_capacity <= LOCAL_CAPACITY) {
+        if (!is_local()) {
+            Heap heap = heap_;
+            memcpy(local_, heap.data, size_ + 1);
+            on_heap_ = false;
+            resource_->deallocate(heap.data, heap.capacity + 1, 1);
+        }
+        return;
+    }
+    char* new_arrays = static_cast<char*>(resource_->allocate(new_capacity + 1, 1));
+    memcpy(new_arrays, data(), size_ + 1);
+    deallocate();
+    heap_.data = new_arrays;
+    heap_.capacity = new_capacity;
+    on_heap_ = true;
+}
+
+size_t String::grown_capacity(size_t min_capacity) const {
+    double factor = growth_factor_.load(std::memory_order_relaxed);
+    size_t grown = static_cast<size_t>(static_cast<double>(capacity()) * factor);
+    return std::max(min_capacity, grown);
+}
+
+String::String(const char* str, std::pmr::memory_resource* resource)
+    : size_(strlen(str)), resource_(resource) {
+    allocate(size_);
+    memcpy(data(), str, size_ + 1);
+}
+
+String::String() : String(std::pmr::get_default_resource()) {}
+
+String::String(std::pmr::memory_resource* resource)
+    : size_(0), on_heap_(false), resource_(resource) {
+    local_[0] = '\0';
+}
+
+String::String(size_t n, char ch, std::pmr::memory_resource* resource)
+    : size_(n), resource_(resource) {
+    allocate(size_);
+    memset(data(), ch, n);
+    data()[n] = '\0';
+}
+
+String::String(const String& str) : String(str, std::pmr::get_default_resource()) {}
+
+String::String(const String& str, std::pmr::memory_resource* resource)
+    : size_(str.size_), resource_(resource) {
+    allocate(size_);
+    memcpy(data(), str.data(), size_ + 1);
+}
+
+String::String(const StringView& view, std::pmr::memory_resource* resource)
+    : size_(view.size()), resource_(resource) {
+    allocate(size_);
+    memcpy(data(), view.data(), size_);
+    data()[size_] = '\0';
+}
+
+String::String(String&& str) noexcept
+    : size_(str.size_), on_heap_(str.on_heap_), resource_(str.resource_) {
+    memcpy(local_, str.local_, sizeof(local_));
+    str.size_ = 0;
+    str.on_heap_ = false;
+    str.local_[0] = '\0';
+}
+
+// Assignment keeps this string's resource; the target's buffer is reused
+// when it is large enough.
+String& String::operator=(const String& str) {
+    if (this != &str) {
+        clear();
+        append(str.data(), str.size_);
+    }
+    return *this;
+}
+
+String& String::operator=(String&& str) {
+    if (this == &str) {
+        return *this;
+    }
+    if (resource_ != str.resource_ && !resource_->is_equal(*str.resource_)) {
+        return *this = static_cast<const String&>(str);
+    }
+    String tmp(std::move(str));
+    swap(tmp);
     return *this;
 }
 
 char& String::operator[](size_t index) {
-    return array_[index];
+    return data()[index];
 }
 
 const char& String::operator[](size_t index) const {
-    return array_[index];
+    return data()[index];
 }
 
 size_t String::length() const {
@@ -83,47 +395,58 @@ size_t String::size() const {
 }
 
 size_t String::capacity() const {
-    return capacity_;
+    return (is_local() ? LOCAL_CAPACITY : heap_.capacity);
+}
+
+void String::reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+        change_capacity(new_capacity);
+    }
+}
+
+void String::resize(size_t new_size, char ch) {
+    if (new_size > capacity()) {
+        change_capacity(grown_capacity(new_size));
+    }
+    if (new_size > size_) {
+        memset(data() + size_, ch, new_size - size_);
+    }
+    size_ = new_size;
+    data()[size_] = '\0';
 }
 
 void String::push_back(char ch) {
-    if (size_ == capacity_) {
-        change_capacity(capacity_ * 2);
+    if (size_ == capacity()) {
+        change_capacity(grown_capacity(size_ + 1));
     }
-    array_[size_] = ch;
+    data()[size_] = ch;
     ++size_;
-    array_[size_] = '\0';
+    data()[size_] = '\0';
 }
 
 void String::pop_back() {
     --size_;
-    array_[size_] = '\0';
+    data()[size_] = '\0';
 }
 
 const char& String::front() const {
-    return array_[0];
+    return data()[0];
 }
 
 char& String::front() {
-    return array_[0];
+    return data()[0];
 }
 
 const char& String::back() const {
-    return array_[size_ - 1];
+    return data()[size_ - 1];
 }
 
 char& String::back() {
-    return array_[size_ - 1];
+    return data()[size_ - 1];
 }
 
 String& String::operator+=(const String& other) {
-    if (size_ + other.size_ > capacity_) {
-        change_capacity(size_ + other.size_);
-    }
-    memcpy(array_ + size_, other.array_, other.size_);
-    size_ += other.size_;
-    array_[size_] = '\0';
-    return *this;
+    return append(other.data(), other.size_);
 }
 
 String& String::operator+=(const char ch) {
@@ -131,27 +454,98 @@ String& String::operator+=(const char ch) {
     return *this;
 }
 
+// `str` may point into this string; it is located again after growing.
+String& String::append(const char* str, size_t count) {
+    if (size_ + count > capacity()) {
+        std::less_equal<const char*> before;
+        bool inside = before(data(), str) && before(str, data() + size_);
+        size_t offset = (inside ? static_cast<size_t>(str - data()) : 0);
+        char* old_array = data();
+        size_t old_capacity = capacity();
+        bool was_local = is_local();
+        size_t new_capacity = grown_capacity(size_ + count);
+        char* new_array = static_cast<char*>(resource_->allocate(new_capacity + 1, 1));
+        memcpy(new_array, old_array, size_);
+        memcpy(new_array + size_, (inside ? new_array + offset : str), count);
+        if (!was_local) {
+            resource_->deallocate(old_array, old_capacity + 1, 1);
+        }
+        heap_.data = new_array;
+        heap_.capacity = new_capacity;
+        on_heap_ = true;
+    } else {
+        memmove(data() + size_, str, count);
+    }
+    size_ += count;
+    data()[size_] = '\0';
+    return *this;
+}
+
 size_t String::find(const String& substr) const {
-    return find(substr, 0, size_ - substr.size_ + 1, 1);
+    size_t pos = search_forward(data(), size_, substr.data(), substr.size_);
+    return (pos == NOT_FOUND ? length() : pos);
 }
 
 size_t String::rfind(const String& substr) const {
-    return find(substr, size_ - substr.size_, substr.size_ - 2, -1);
+    size_t pos = search_backward(data(), size_, substr.data(), substr.size_);
+    return (pos == NOT_FOUND ? length() : pos);
+}
+
+String String::substr(size_t start, size_t count) const {
+    return String(view(start, count));
+}
+
+StringView String::view(size_t start, size_t count) const {
+    return StringView(data() + start, count);
+}
+
+SplitRange String::split(const StringView& delimiter) const& {
+    return SplitRange(*this, delimiter, false);
+}
+
+SplitRange String::tokenize(const StringView& delimiters) const& {
+    return SplitRange(*this, delimiters, true);
+}
+
+bool String::is_valid_utf8() const {
+    return utf8_validate(*this);
+}
+
+std::u16string String::to_utf16() const {
+    return utf8_to_utf16(*this);
+}
+
+std::u32string String::to_utf32() const {
+    return utf8_to_utf32(*this);
+}
+
+String String::to_lower() const {
+    String result(*this, resource_);
+    ascii_to_lower(result.data(), result.size_);
+    return result;
 }
 
-String String::substr(size_t start, int count) const {
-    String result(count);
-    memcpy(result.array_, array_ + start, count);
+String String::to_upper() const {
+    String result(*this, resource_);
+    ascii_to_upper(result.data(), result.size_);
     return result;
 }
 
+int String::compare_ignore_case(const StringView& other) const {
+    return ascii_compare_ignore_case(*this, other);
+}
+
+size_t String::find_ignore_case(const StringView& substr) const {
+    return ascii_find_ignore_case(*this, substr);
+}
+
 bool String::empty() const {
     return size_ == 0;
 }
 
 void String::clear() {
     size_ = 0;
-    array_[size_] = '\0';
+    data()[size_] = '\0';
 }
 
 void String::shrink_to_fit() {
@@ -159,22 +553,34 @@ void String::shrink_to_fit() {
 }
 
 char* String::data() {
-    return array_;
+    return (is_local() ? local_ : heap_.data);
 }
 
 const char* String::data() const {
-    return array_;
+    return (is_local() ? local_ : heap_.data);
+}
+
+size_t String::hash() const {
+    return static_cast<size_t>(hash_bytes(data(), size_, 0));
+}
+
+std::pmr::polymorphic_allocator<char> String::get_allocator() const {
+    return resource_;
+}
+
+void String::set_growth_factor(double factor) {
+    assert(factor > 1);
+    growth_factor_.store(factor, std::memory_order_relaxed);
 }
 
 String::~String() {
-    delete[] array_;
+    deallocate();
 }
 
 bool operator<(const String& a, const String& b) {
-    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
-        if (a[i] != b[i]) {
-            return a[i] < b[i];
-        }
+    int cmp = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    if (cmp != 0) {
+        return cmp < 0;
     }
     return a.size() < b.size();
 }
@@ -195,12 +601,7 @@ bool operator==(const String& a, const String& b) {
     if (a.size() != b.size()) {
         return false;
     }
-    for (size_t i = 0; i < a.size(); ++i) {
-        if (a[i] != b[i]) {
-            return false;
-        }
-    }
-    return true;
+    return memcmp(a.data(), b.data(), a.size()) == 0;
 }
 
 bool operator!=(const String& a, const String& b) {
@@ -208,28 +609,53 @@ bool operator!=(const String& a, const String& b) {
 }
 
 std::ostream& operator<<(std::ostream& out, const String& str) {
-    out << str.data();
+    out.write(str.data(), static_cast<std::streamsize>(str.size()));
     return out;
 }
 
+// Pulls characters straight from the stream buffer and appends them in
+// chunks instead of going through istream::get for every character.
 std::istream& operator>>(std::istream& in, String& str) {
     str.clear();
-    char tmp;
-    while (in.get(tmp)) {
-        if (std::isspace(tmp) != 0) {
-            break;
+    std::istream::sentry sentry(in);
+    if (!sentry) {
+        return in;
+    }
+    std::streambuf* buf = in.rdbuf();
+    char chunk[256];
+    size_t count = 0;
+    int ch = buf->sgetc();
+    while (ch != std::char_traits<char>::eof() && std::isspace(ch) == 0) {
+        chunk[count++] = static_cast<char>(ch);
+        if (count == sizeof(chunk)) {
+            str.append(chunk, count);
+            count = 0;
         }
-        str.push_back(tmp);
+        ch = buf->snextc();
+    }
+    str.append(chunk, count);
+    if (ch == std::char_traits<char>::eof()) {
+        in.setstate(std::ios_base::eofbit);
+    }
+    if (str.empty()) {
+        in.setstate(std::ios_base::failbit);
     }
     return in;
 }
 
 String operator+(const String& a, const String& b) {
-    String result = a;
+    String result;
+    result.reserve(a.size() + b.size());
+    result += a;
     result += b;
     return result;
 }
 
+String operator+(String&& a, const String& b) {
+    a += b;
+    return std::move(a);
+}
+
 String operator+(const String& a, char ch) {
     String result = a;
     result += ch;
@@ -241,3 +667,275 @@ String operator+(char ch, const String& a) {
     result += a;
     return result;
 }
+
+StringView::StringView(const char* str) : data_(str), size_(strlen(str)) {}
+
+StringView::StringView(const char* str, size_t count) : data_(str), size_(count) {}
+
+StringView::StringView(const String& str) : data_(str.data()), size_(str.size()) {}
+
+const char& StringView::operator[](size_t index) const {
+    return data_[index];
+}
+
+size_t StringView::length() const {
+    return size_;
+}
+
+size_t StringView::size() const {
+    return size_;
+}
+
+const char& StringView::front() const {
+    return data_[0];
+}
+
+const char& StringView::back() const {
+    return data_[size_ - 1];
+}
+
+size_t StringView::find(const StringView& substr) const {
+    size_t pos = search_forward(data_, size_, substr.data_, substr.size_);
+    return (pos == NOT_FOUND ? length() : pos);
+}
+
+size_t StringView::rfind(const StringView& substr) const {
+    size_t pos = search_backward(data_, size_, substr.data_, substr.size_);
+    return (pos == NOT_FOUND ? length() : pos);
+}
+
+StringView StringView::substr(size_t start, size_t count) const {
+    return StringView(data_ + start, count);
+}
+
+SplitRange StringView::split(const StringView& delimiter) const {
+    return SplitRange(*this, delimiter, false);
+}
+
+SplitRange StringView::tokenize(const StringView& delimiters) const {
+    return SplitRange(*this, delimiters, true);
+}
+
+bool StringView::empty() const {
+    return size_ == 0;
+}
+
+const char* StringView::data() const {
+    return data_;
+}
+
+size_t StringView::hash() const {
+    return static_cast<size_t>(hash_bytes(data_, size_, 0));
+}
+
+bool operator<(const StringView& a, const StringView& b) {
+    int cmp = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    if (cmp != 0) {
+        return cmp < 0;
+    }
+    return a.size() < b.size();
+}
+
+bool operator>(const StringView& a, const StringView& b) {
+    return b < a;
+}
+
+bool operator<=(const StringView& a, const StringView& b) {
+    return !(a > b);
+}
+
+bool operator>=(const StringView& a, const StringView& b) {
+    return !(a < b);
+}
+
+bool operator==(const StringView& a, const StringView& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    return memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool operator!=(const StringView& a, const StringView& b) {
+    return !(a == b);
+}
+
+std::ostream& operator<<(std::ostream& out, const StringView& view) {
+    out.write(view.data(), static_cast<std::streamsize>(view.size()));
+    return out;
+}
+
+SplitRange::SplitRange(const StringView& text, const StringView& delimiter, bool tokenize)
+    : text_(text), delimiter_(delimiter), tokenize_(tokenize) {
+    for (size_t i = 0; i < delimiter.size(); ++i) {
+        is_delimiter_[static_cast<unsigned char>(delimiter[i])] = true;
+    }
+}
+
+SplitRange::Iterator SplitRange::begin() const {
+    return Iterator(this);
+}
+
+SplitRange::Iterator SplitRange::end() const {
+    return Iterator();
+}
+
+SplitRange::Iterator::Iterator(const SplitRange* range) : range_(range) {
+    advance();
+}
+
+// pos_ is where the next field starts; a split that has consumed its
+// last field moves it past the end of the text.
+void SplitRange::Iterator::advance() {
+    const StringView& text = range_->text_;
+    if (range_->tokenize_) {
+        while (pos_ < text.size() && range_->is_delimiter_[static_cast<unsigned char>(text[pos_])]) {
+            ++pos_;
+        }
+        if (pos_ == text.size()) {
+            *this = Iterator();
+            return;
+        }
+        size_t start = pos_;
+        while (pos_ < text.size() && !range_->is_delimiter_[static_cast<unsigned char>(text[pos_])]) {
+            ++pos_;
+        }
+        current_ = text.substr(start, pos_ - start);
+        return;
+    }
+    if (pos_ > text.size()) {
+        *this = Iterator();
+        return;
+    }
+    const StringView& delimiter = range_->delimiter_;
+    StringView rest = text.substr(pos_, text.size() - pos_);
+    size_t found = rest.size();
+    if (delimiter.size() == 1) {
+        const void* hit = memchr(rest.data(), delimiter[0], rest.size());
+        if (hit != nullptr) {
+            found = static_cast<size_t>(static_cast<const char*>(hit) - rest.data());
+        }
+    } else if (!delimiter.empty()) {
+        found = rest.find(delimiter);
+    }
+    current_ = rest.substr(0, found);
+    pos_ += (found == rest.size() ? found + 1 : found + delimiter.size());
+}
+
+const StringView& SplitRange::Iterator::operator*() const {
+    return current_;
+}
+
+const StringView* SplitRange::Iterator::operator->() const {
+    return &current_;
+}
+
+SplitRange::Iterator& SplitRange::Iterator::operator++() {
+    advance();
+    return *this;
+}
+
+SplitRange::Iterator SplitRange::Iterator::operator++(int) {
+    Iterator copy = *this;
+    advance();
+    return copy;
+}
+
+bool SplitRange::Iterator::operator==(const Iterator& other) const {
+    return range_ == other.range_ && pos_ == other.pos_;
+}
+
+bool SplitRange::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+SharedString::SharedString(const char* str, size_t count) : size_(count) {
+    if (count == 0) {
+        return;
+    }
+    void* memory = ::operator new(sizeof(Buffer) + count);
+    buffer_ = new (memory) Buffer{{1}, count};
+    char* chars = reinterpret_cast<char*>(buffer_ + 1);
+    memcpy(chars, str, count);
+    data_ = chars;
+}
+
+SharedString::SharedString(const char* str) : SharedString(str, strlen(str)) {}
+
+SharedString::SharedString(const StringView& view) : SharedString(view.data(), view.size()) {}
+
+SharedString::SharedString(const SharedString& str)
+    : buffer_(str.buffer_), data_(str.data_), size_(str.size_) {
+    if (buffer_ != nullptr) {
+        buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SharedString::swap(SharedString& str) {
+    std::swap(buffer_, str.buffer_);
+    std::swap(data_, str.data_);
+    std::swap(size_, str.size_);
+}
+
+SharedString& SharedString::operator=(SharedString str) {
+    swap(str);
+    return *this;
+}
+
+const char& SharedString::operator[](size_t index) const {
+    return data_[index];
+}
+
+size_t SharedString::length() const {
+    return size_;
+}
+
+size_t SharedString::size() const {
+    return size_;
+}
+
+size_t SharedString::find(const StringView& substr) const {
+    return view().find(substr);
+}
+
+size_t SharedString::rfind(const StringView& substr) const {
+    return view().rfind(substr);
+}
+
+SharedString SharedString::substr(size_t start, size_t count) const {
+    SharedString result(*this);
+    result.data_ += start;
+    result.size_ = count;
+    return result;
+}
+
+StringView SharedString::view() const {
+    return StringView(data_, size_);
+}
+
+SharedString::operator StringView() const {
+    return view();
+}
+
+bool SharedString::empty() const {
+    return size_ == 0;
+}
+
+const char* SharedString::data() const {
+    return data_;
+}
+
+size_t SharedString::use_count() const {
+    return (buffer_ == nullptr ? 0 : buffer_->refs.load(std::memory_order_relaxed));
+}
+
+size_t SharedString::hash() const {
+    return view().hash();
+}
+
+SharedString::~SharedString() {
+    if (buffer_ != nullptr && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        size_t bytes = sizeof(Buffer) + buffer_->size;
+        buffer_->~Buffer();
+        ::operator delete(buffer_, bytes);
+    }
+}
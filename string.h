@@ -1,30 +1,69 @@
+#pragma once
+#include <atomic>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <string>
+
+class StringView;
+class SplitRange;
 
 class String {
   private:
-    size_t size_ = 0;
-    size_t capacity_ = 0;
-    char* array_ = nullptr;
+    struct Heap {
+        char* data;
+        size_t capacity;
+    };
+
+    static const size_t LOCAL_CAPACITY = sizeof(Heap) - 1;
+    static const int SIZE_BITS = std::numeric_limits<size_t>::digits - 1;
+
+    // 32 bytes on 64-bit targets: strings of up to LOCAL_CAPACITY
+    // characters live in local_, longer ones in heap_, and the top bit of
+    // the size word says which. The union holds no pointer into the
+    // object itself, so moves and swaps copy it as plain bytes. The word
+    // beyond libc++'s 24 is the pmr resource every String carries.
+    size_t size_ : SIZE_BITS;
+    size_t on_heap_ : 1;
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+    union {
+        Heap heap_;
+        char local_[LOCAL_CAPACITY + 1];
+    };
 
-    explicit String(int count);
+    static std::atomic<double> growth_factor_;
+
+    bool is_local() const;
+    void allocate(size_t capacity);
+    void deallocate();
     void swap(String& str);
     void change_capacity(size_t new_capacity);
-    static bool check(char* str_begin, const char* str_end, char* substr_begin);
-    size_t find(const String& substr, size_t start, size_t stop,
-                int step) const;
+    size_t grown_capacity(size_t min_capacity) const;
 
   public:
-    String(const char* str);
+    String(const char* str,
+           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     String();
-    String(size_t n, char ch);
+    explicit String(std::pmr::memory_resource* resource);
+    String(size_t n, char ch,
+           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     String(const String& str);
-    String& operator=(String str);
+    String(const String& str, std::pmr::memory_resource* resource);
+    String(String&& str) noexcept;
+    explicit String(const StringView& view,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    String& operator=(const String& str);
+    String& operator=(String&& str);
     char& operator[](size_t index);
     const char& operator[](size_t index) const;
     size_t length() const;
     size_t size() const;
     size_t capacity() const;
+    void reserve(size_t new_capacity);
+    void resize(size_t new_size, char ch = '\0');
     void push_back(char ch);
     void pop_back();
     const char& front() const;
@@ -33,14 +72,31 @@ class String {
     char& back();
     String& operator+=(const String& other);
     String& operator+=(char ch);
+    String& append(const char* str, size_t count);
     size_t find(const String& substr) const;
     size_t rfind(const String& substr) const;
-    String substr(size_t start, int count) const;
+    String substr(size_t start, size_t count) const;
+    StringView view(size_t start, size_t count) const;
+    SplitRange split(const StringView& delimiter) const&;
+    SplitRange split(const StringView& delimiter) && = delete;
+    SplitRange tokenize(const StringView& delimiters) const&;
+    SplitRange tokenize(const StringView& delimiters) && = delete;
+    bool is_valid_utf8() const;
+    std::u16string to_utf16() const;
+    std::u32string to_utf32() const;
+    String to_lower() const;
+    String to_upper() const;
+    int compare_ignore_case(const StringView& other) const;
+    size_t find_ignore_case(const StringView& substr) const;
     bool empty() const;
     void clear();
     void shrink_to_fit();
     char* data();
     const char* data() const;
+    size_t hash() const;
+    std::pmr::polymorphic_allocator<char> get_allocator() const;
+    // Capacity is multiplied by `factor` (> 1) whenever appends outgrow it.
+    static void set_growth_factor(double factor);
     ~String();
 };
 
@@ -62,6 +118,150 @@ std::istream& operator>>(std::istream& in, String& str);
 
 String operator+(const String& a, const String& b);
 
+String operator+(String&& a, const String& b);
+
 String operator+(const String& a, char ch);
 
 String operator+(char ch, const String& a);
+
+// Non-owning slice of characters; not null-terminated.
+class StringView {
+  private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+  public:
+    StringView() = default;
+    StringView(const char* str);
+    StringView(const char* str, size_t count);
+    StringView(const String& str);
+    const char& operator[](size_t index) const;
+    size_t length() const;
+    size_t size() const;
+    const char& front() const;
+    const char& back() const;
+    size_t find(const StringView& substr) const;
+    size_t rfind(const StringView& substr) const;
+    StringView substr(size_t start, size_t count) const;
+    SplitRange split(const StringView& delimiter) const;
+    SplitRange tokenize(const StringView& delimiters) const;
+    bool empty() const;
+    const char* data() const;
+    size_t hash() const;
+};
+
+bool operator<(const StringView& a, const StringView& b);
+
+bool operator>(const StringView& a, const StringView& b);
+
+bool operator<=(const StringView& a, const StringView& b);
+
+bool operator>=(const StringView& a, const StringView& b);
+
+bool operator==(const StringView& a, const StringView& b);
+
+bool operator!=(const StringView& a, const StringView& b);
+
+std::ostream& operator<<(std::ostream& out, const StringView& view);
+
+// Lazily walks the fields of a string as views into it, without
+// allocating. split() yields every field between occurrences of the
+// delimiter, empty ones included; tokenize() yields the non-empty runs
+// between any of the delimiter characters.
+class SplitRange {
+  public:
+    class Iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StringView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StringView*;
+        using reference = const StringView&;
+
+        Iterator() = default;
+        const StringView& operator*() const;
+        const StringView* operator->() const;
+        Iterator& operator++();
+        Iterator operator++(int);
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+      private:
+        friend class SplitRange;
+
+        explicit Iterator(const SplitRange* range);
+        void advance();
+
+        const SplitRange* range_ = nullptr;
+        size_t pos_ = 0;
+        StringView current_;
+    };
+
+    SplitRange(const StringView& text, const StringView& delimiter, bool tokenize);
+    Iterator begin() const;
+    Iterator end() const;
+
+  private:
+    StringView text_;
+    StringView delimiter_;
+    bool tokenize_;
+    bool is_delimiter_[256] = {};
+};
+
+// Immutable string whose buffer is shared by copies and substrings and
+// freed with the last reference.
+class SharedString {
+  private:
+    struct Buffer {
+        std::atomic<size_t> refs;
+        size_t size;
+    };
+
+    Buffer* buffer_ = nullptr;
+    const char* data_ = "";
+    size_t size_ = 0;
+
+    explicit SharedString(const char* str, size_t count);
+    void swap(SharedString& str);
+
+  public:
+    SharedString() = default;
+    SharedString(const char* str);
+    explicit SharedString(const StringView& view);
+    SharedString(const SharedString& str);
+    SharedString& operator=(SharedString str);
+    const char& operator[](size_t index) const;
+    size_t length() const;
+    size_t size() const;
+    size_t find(const StringView& substr) const;
+    size_t rfind(const StringView& substr) const;
+    SharedString substr(size_t start, size_t count) const;
+    StringView view() const;
+    operator StringView() const;
+    bool empty() const;
+    const char* data() const;
+    size_t use_count() const;
+    size_t hash() const;
+    ~SharedString();
+};
+
+template <>
+struct std::hash<String> {
+    size_t operator()(const String& str) const {
+        return str.hash();
+    }
+};
+
+template <>
+struct std::hash<StringView> {
+    size_t operator()(const StringView& view) const {
+        return view.hash();
+    }
+};
+
+template <>
+struct std::hash<SharedString> {
+    size_t operator()(const SharedString& str) const {
+        return str.hash();
+    }
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join work. A thread waiting for
+// its forked tasks runs queued tasks meanwhile instead of blocking, so
+// recursive algorithms can fork from inside tasks without deadlocking.
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        for (size_t i = 1; i < threads; ++i) {
+            _workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    // Number of threads taking part in parallel calls, the caller included.
+    size_t size() const {
+        return _workers.size() + 1;
+    }
+
+    // Runs both functions, `right` possibly on another thread, and returns
+    // when both are done. An exception from either is rethrown here.
+    template <typename Left, typename Right>
+    void parallelInvoke(Left&& left, Right&& right) {
+        if (_workers.empty()) {
+            left();
+            right();
+            return;
+        }
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+        push([&] {
+            try {
+                right();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            done.store(true, std::memory_order_release);
+        });
+        std::exception_ptr left_error;
+        try {
+            left();
+        } catch (...) {
+            left_error = std::current_exception();
+        }
+        waitFor(done);
+        if (left_error) {
+            std::rethrow_exception(left_error);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Calls func(i) for every i in [begin, end), in chunks of at least
+    // `grain` indices spread over the pool.
+    template <typename Func>
+    void parallelFor(size_t begin, size_t end, size_t grain, Func func) {
+        if (end <= begin) {
+            return;
+        }
+        if (end - begin <= grain || _workers.empty()) {
+            for (size_t i = begin; i < end; ++i) {
+                func(i);
+            }
+            return;
+        }
+        size_t middle = begin + (end - begin) / 2;
+        parallelInvoke([&] { parallelFor(begin, middle, grain, func); },
+                       [&] { parallelFor(middle, end, grain, func); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _ready.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+  private:
+    void push(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _ready.notify_one();
+    }
+
+    // A waiting thread takes the newest task, likely its own fork with
+    // data still in cache; idle workers take the oldest, which in a
+    // recursion is the largest piece left.
+    bool runOne() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_tasks.empty()) {
+                return false;
+            }
+            task = std::move(_tasks.back());
+            _tasks.pop_back();
+        }
+        task();
+        return true;
+    }
+
+    void waitFor(const std::atomic<bool>& done) {
+        while (!done.load(std::memory_order_acquire)) {
+            if (!runOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _ready.wait(lock, [this] { return _stop || !_tasks.empty(); });
+                if (_tasks.empty()) {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    bool _stop = false;
+};
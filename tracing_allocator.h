@@ -0,0 +1,237 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#endif
+
+// Shared counters for TracingAllocator and TracingResource. Sizes go into
+// power-of-two histogram buckets; with a non-zero `sample_every`, every
+// n-th allocation also records a short call stack.
+class AllocationStats {
+  public:
+    static const size_t HISTOGRAM_SIZE = 64;
+    static const size_t STACK_DEPTH = 16;
+    static const size_t MAX_SAMPLES = 1024;
+
+    struct Sample {
+        size_t bytes;
+        size_t depth;
+        void* stack[STACK_DEPTH];
+    };
+
+    explicit AllocationStats(size_t sample_every = 0)
+        : _sample_every(sample_every) {}
+    AllocationStats(const AllocationStats& other) = delete;
+
+    void recordAllocation(size_t bytes) {
+        size_t number = _allocations.fetch_add(1, std::memory_order_relaxed);
+        _bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        size_t in_use = _bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = _peak_bytes.load(std::memory_order_relaxed);
+        while (in_use > peak &&
+               !_peak_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+        }
+        _histogram[bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+        if (_sample_every != 0 && number % _sample_every == 0) {
+            recordSample(bytes);
+        }
+    }
+
+    void recordDeallocation(size_t bytes) {
+        _deallocations.fetch_add(1, std::memory_order_relaxed);
+        _bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t allocations() const {
+        return _allocations.load(std::memory_order_relaxed);
+    }
+
+    size_t deallocations() const {
+        return _deallocations.load(std::memory_order_relaxed);
+    }
+
+    size_t bytesAllocated() const {
+        return _bytes_allocated.load(std::memory_order_relaxed);
+    }
+
+    size_t bytesInUse() const {
+        return _bytes_in_use.load(std::memory_order_relaxed);
+    }
+
+    size_t peakBytes() const {
+        return _peak_bytes.load(std::memory_order_relaxed);
+    }
+
+    // Number of allocations of at most 2^i bytes and more than 2^(i-1).
+    size_t histogram(size_t i) const {
+        return _histogram[i].load(std::memory_order_relaxed);
+    }
+
+    std::vector<Sample> samples() const {
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        return _samples;
+    }
+
+    void dumpJson(std::ostream& out) const {
+        out << "{\"allocations\":" << allocations() << ",\"deallocations\":" << deallocations()
+            << ",\"bytes_allocated\":" << bytesAllocated() << ",\"bytes_in_use\":" << bytesInUse()
+            << ",\"peak_bytes\":" << peakBytes() << ",\"histogram\":[";
+        bool first = true;
+        for (size_t i = 0; i < HISTOGRAM_SIZE; ++i) {
+            if (histogram(i) == 0) {
+                continue;
+            }
+            out << (first ? "" : ",") << "{\"max_bytes\":" << (size_t(1) << i)
+                << ",\"count\":" << histogram(i) << '}';
+            first = false;
+        }
+        out << "],\"samples\":[";
+        first = true;
+        for (const Sample& sample : samples()) {
+            out << (first ? "" : ",") << "{\"bytes\":" << sample.bytes << ",\"stack\":[";
+            for (size_t i = 0; i < sample.depth; ++i) {
+                out << (i == 0 ? "" : ",") << '"' << sample.stack[i] << '"';
+            }
+            out << "]}";
+            first = false;
+        }
+        out << "]}";
+    }
+
+    std::string toJson() const {
+        std::ostringstream out;
+        dumpJson(out);
+        return out.str();
+    }
+
+  private:
+    static size_t bucket(size_t bytes) {
+        size_t i = 0;
+        while (i + 1 < HISTOGRAM_SIZE && (size_t(1) << i) < bytes) {
+            ++i;
+        }
+        return i;
+    }
+
+    void recordSample(size_t bytes) {
+        Sample sample{bytes, 0, {}};
+#if __has_include(<execinfo.h>)
+        sample.depth = static_cast<size_t>(backtrace(sample.stack, STACK_DEPTH));
+#endif
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        if (_samples.size() < MAX_SAMPLES) {
+            _samples.push_back(sample);
+        }
+    }
+
+    size_t _sample_every;
+    std::atomic<size_t> _allocations{0};
+    std::atomic<size_t> _deallocations{0};
+    std::atomic<size_t> _bytes_allocated{0};
+    std::atomic<size_t> _bytes_in_use{0};
+    std::atomic<size_t> _peak_bytes{0};
+    std::atomic<size_t> _histogram[HISTOGRAM_SIZE]{};
+    mutable std::mutex _samples_mutex;
+    std::vector<Sample> _samples;
+};
+
+// Wraps any allocator (std::allocator, StackAllocator, ...) and reports
+// every allocation to an AllocationStats.
+template <typename T, typename Base = std::allocator<T>>
+class TracingAllocator {
+  private:
+    using BaseTraits = std::allocator_traits<Base>;
+
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment =
+        typename BaseTraits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment =
+        typename BaseTraits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename BaseTraits::propagate_on_container_swap;
+
+    TracingAllocator(AllocationStats& stats, const Base& base = Base())
+        : _stats(&stats), _base(base) {}
+    template <typename U, typename OtherBase>
+    TracingAllocator(const TracingAllocator<U, OtherBase>& other)
+        : _stats(other.getStats()), _base(other.getBase()) {}
+
+    bool operator==(const TracingAllocator& other) const {
+        return _stats == other._stats && _base == other._base;
+    }
+    bool operator!=(const TracingAllocator& other) const {
+        return !(operator==(other));
+    }
+
+    T* allocate(size_t count) {
+        T* res = BaseTraits::allocate(_base, count);
+        _stats->recordAllocation(sizeof(T) * count);
+        return res;
+    }
+
+    void deallocate(T* ptr, size_t count) {
+        _stats->recordDeallocation(sizeof(T) * count);
+        BaseTraits::deallocate(_base, ptr, count);
+    }
+
+    TracingAllocator select_on_container_copy_construction() const {
+        return TracingAllocator(*_stats, BaseTraits::select_on_container_copy_construction(_base));
+    }
+
+    AllocationStats* getStats() const {
+        return _stats;
+    }
+
+    const Base& getBase() const {
+        return _base;
+    }
+
+    template <typename U>
+    struct rebind {
+        using other = TracingAllocator<U, typename BaseTraits::template rebind_alloc<U>>;
+    };
+
+  private:
+    AllocationStats* _stats;
+    Base _base;
+};
+
+// The same for std::pmr users such as String.
+class TracingResource : public std::pmr::memory_resource {
+  public:
+    TracingResource(AllocationStats& stats,
+                    std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : _stats(&stats), _upstream(upstream) {}
+
+    AllocationStats* getStats() const {
+        return _stats;
+    }
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* res = _upstream->allocate(bytes, alignment);
+        _stats->recordAllocation(bytes);
+        return res;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        _stats->recordDeallocation(bytes);
+        _upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    AllocationStats* _stats;
+    std::pmr::memory_resource* _upstream;
+};
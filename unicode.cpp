@@ -0,0 +1,424 @@
+#include "unicode.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UNICODE_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const uint64_t ASCII_MASK = 0x8080808080808080ULL;
+const char32_t REPLACEMENT = 0xFFFD;
+
+// Length of the well-formed sequence at the start of `s`, or 0.
+size_t utf8_decode(const unsigned char* s, size_t size, char32_t& code_point) {
+    unsigned char lead = s[0];
+    if (lead < 0x80) {
+        code_point = lead;
+        return 1;
+    }
+    if (lead < 0xC2 || lead > 0xF4) {
+        return 0;
+    }
+    if (lead < 0xE0) {
+        if (size < 2 || (s[1] & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (char32_t(lead & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    unsigned char lo = (lead == 0xE0 ? 0xA0 : lead == 0xF0 ? 0x90 : 0x80);
+    unsigned char hi = (lead == 0xED ? 0x9F : lead == 0xF4 ? 0x8F : 0xBF);
+    size_t length = (lead < 0xF0 ? 3 : 4);
+    if (size < length || s[1] < lo || s[1] > hi) {
+        return 0;
+    }
+    code_point = char32_t(lead & (length == 3 ? 0x0F : 0x07));
+    for (size_t i = 1; i < length; ++i) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (s[i] & 0x3F);
+    }
+    return length;
+}
+
+bool utf8_is_ascii_word(const unsigned char* s) {
+    uint64_t word;
+    memcpy(&word, s, sizeof(word));
+    return (word & ASCII_MASK) == 0;
+}
+
+bool utf8_validate_scalar(const unsigned char* s, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (i + 8 <= size && utf8_is_ascii_word(s + i)) {
+            i += 8;
+            continue;
+        }
+        char32_t code_point;
+        size_t length = utf8_decode(s + i, size - i, code_point);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+#ifdef UNICODE_X86
+// Keiser and Lemire's lookup algorithm: three 16-entry nibble tables,
+// indexed by the previous byte's halves and the current byte's high
+// nibble, flag every two-byte error pattern; a separate check catches
+// missing or surplus continuation bytes three positions back.
+const uint8_t TOO_SHORT = 1 << 0;
+const uint8_t TOO_LONG = 1 << 1;
+const uint8_t OVERLONG_3 = 1 << 2;
+const uint8_t TOO_LARGE = 1 << 3;
+const uint8_t SURROGATE = 1 << 4;
+const uint8_t OVERLONG_2 = 1 << 5;
+const uint8_t TOO_LARGE_1000 = 1 << 6;
+const uint8_t OVERLONG_4 = 1 << 6;
+const uint8_t TWO_CONTS = 1 << 7;
+const uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+__attribute__((target("avx2"))) __m256i utf8_table(const uint8_t (&table)[16]) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+template <int N>
+__attribute__((target("avx2"))) __m256i utf8_prev(__m256i input, __m256i prev_input) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+}
+
+__attribute__((target("avx2"))) bool utf8_validate_avx2(const unsigned char* s, size_t size) {
+    static const uint8_t byte_1_high[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+    static const uint8_t byte_1_low[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000};
+    static const uint8_t byte_2_high[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+    static const uint8_t incomplete[32] = {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+    const __m256i table_1_high = utf8_table(byte_1_high);
+    const __m256i table_1_low = utf8_table(byte_1_low);
+    const __m256i table_2_high = utf8_table(byte_2_high);
+    const __m256i max_value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(incomplete));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < size; i += 32) {
+        __m256i input;
+        if (i + 32 <= size) {
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        } else {
+            unsigned char tail[32] = {};
+            memcpy(tail, s + i, size - i);
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+        }
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_input = input;
+            prev_incomplete = _mm256_setzero_si256();
+            continue;
+        }
+        __m256i prev1 = utf8_prev<1>(input, prev_input);
+        __m256i prev1_high = _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble);
+        __m256i input_high = _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble);
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(table_1_high, prev1_high),
+                             _mm256_shuffle_epi8(table_1_low, _mm256_and_si256(prev1, low_nibble))),
+            _mm256_shuffle_epi8(table_2_high, input_high));
+        __m256i third = _mm256_subs_epu8(utf8_prev<2>(input, prev_input), _mm256_set1_epi8(0xE0 - 0x80));
+        __m256i fourth = _mm256_subs_epu8(utf8_prev<3>(input, prev_input), _mm256_set1_epi8(0xF0 - 0x80));
+        __m256i must_continue =
+            _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must_continue, special));
+        prev_incomplete = _mm256_subs_epu8(input, max_value);
+        prev_input = input;
+    }
+    error = _mm256_or_si256(error, prev_incomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+bool utf8_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+using ValidateFunction = bool (*)(const unsigned char*, size_t);
+
+ValidateFunction utf8_select_validate() {
+#ifdef UNICODE_X86
+    return (utf8_has_avx2() ? utf8_validate_avx2 : utf8_validate_scalar);
+#else
+    return utf8_validate_scalar;
+#endif
+}
+
+#ifdef UNICODE_X86
+template <typename Char>
+__attribute__((target("sse2"))) void utf8_widen_ascii_sse2(const unsigned char* s, size_t size,
+                                                             size_t& i, Char* out, size_t& j) {
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16, j += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        if (_mm_movemask_epi8(input) != 0) {
+            break;
+        }
+        __m128i low = _mm_unpacklo_epi8(input, zero);
+        __m128i high = _mm_unpackhi_epi8(input, zero);
+        if constexpr (sizeof(Char) == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j + 8), high);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j + 12), _mm_unpackhi_epi16(high, zero));
+        }
+    }
+}
+#endif
+
+// Copies the ASCII prefix of s[i..size) into out[j..), widening each
+// byte, and advances both positions past it.
+template <typename Char>
+void utf8_widen_ascii(const unsigned char* s, size_t size, size_t& i, Char* out, size_t& j) {
+#ifdef UNICODE_X86
+    utf8_widen_ascii_sse2(s, size, i, out, j);
+#endif
+    while (i < size && s[i] < 0x80) {
+        out[j++] = s[i++];
+    }
+}
+
+// Neither encoding needs more units than the input has bytes, so the
+// result is sized up front and trimmed at the end.
+template <typename Result>
+Result utf8_transcode(const StringView& text) {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    size_t size = text.size();
+    Result result(size, 0);
+    auto* out = &result[0];
+    size_t i = 0;
+    size_t j = 0;
+    while (true) {
+        utf8_widen_ascii(s, size, i, out, j);
+        if (i == size) {
+            break;
+        }
+        char32_t code_point;
+        size_t length = utf8_decode(s + i, size - i, code_point);
+        if (length == 0) {
+            code_point = REPLACEMENT;
+            length = 1;
+        }
+        i += length;
+        if constexpr (sizeof(typename Result::value_type) == 2) {
+            if (code_point >= 0x10000) {
+                code_point -= 0x10000;
+                out[j++] = static_cast<char16_t>(0xD800 + (code_point >> 10));
+                out[j++] = static_cast<char16_t>(0xDC00 + (code_point & 0x3FF));
+                continue;
+            }
+        }
+        out[j++] = static_cast<typename Result::value_type>(code_point);
+    }
+    result.resize(j);
+    return result;
+}
+
+char ascii_fold(char ch) {
+    return (static_cast<unsigned char>(ch - 'A') < 26 ? static_cast<char>(ch + 32) : ch);
+}
+
+#ifdef UNICODE_X86
+// Handles the whole 16-byte blocks and returns how many bytes it did.
+__attribute__((target("sse2"))) size_t ascii_shift_range_sse2(char* data, size_t size, char first,
+                                                                char delta) {
+    size_t i = 0;
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(-128 - first));
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i shift = _mm_set1_epi8(delta);
+    for (; i + 16 <= size; i += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i in_range = _mm_cmplt_epi8(_mm_add_epi8(input, bias), limit);
+        input = _mm_add_epi8(input, _mm_and_si128(in_range, shift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), input);
+    }
+    return i;
+}
+#endif
+
+// Adds `delta` to every byte in [first, first + 26).
+void ascii_shift_range(char* data, size_t size, char first, char delta) {
+    size_t i = 0;
+#ifdef UNICODE_X86
+    i = ascii_shift_range_sse2(data, size, first, delta);
+#endif
+    for (; i < size; ++i) {
+        if (static_cast<unsigned char>(data[i] - first) < 26) {
+            data[i] = static_cast<char>(data[i] + delta);
+        }
+    }
+}
+
+bool ascii_equal_ignore_case(const char* a, const char* b, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (ascii_fold(a[i]) != ascii_fold(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef UNICODE_X86
+__attribute__((target("sse2"))) __m128i ascii_fold_block(__m128i input) {
+    __m128i in_range = _mm_cmplt_epi8(_mm_add_epi8(input, _mm_set1_epi8(static_cast<char>(-128 - 'A'))),
+                                      _mm_set1_epi8(-128 + 26));
+    return _mm_add_epi8(input, _mm_and_si128(in_range, _mm_set1_epi8(32)));
+}
+
+__attribute__((target("sse2"))) __m128i ascii_either_case(__m128i input, char ch) {
+    char folded = ascii_fold(ch);
+    char other = (folded >= 'a' && folded <= 'z' ? static_cast<char>(folded - 32) : folded);
+    return _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(folded)),
+                        _mm_cmpeq_epi8(input, _mm_set1_epi8(other)));
+}
+
+// Skips the leading 16-byte blocks on which a and b agree up to case and
+// returns the offset of the first block that differs.
+__attribute__((target("sse2"))) size_t ascii_equal_prefix_sse2(const char* a, const char* b,
+                                                                 size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i block_a = ascii_fold_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m128i block_b = ascii_fold_block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block_a, block_b)) != 0xFFFF) {
+            break;
+        }
+    }
+    return i;
+}
+
+// Scans 16 candidate positions at a time from i. Returns the first match,
+// or n with i left at the first position the blocks did not cover.
+__attribute__((target("sse2"))) size_t ascii_find_ignore_case_sse2(const char* haystack, size_t n,
+                                                                     const char* needle, size_t m,
+                                                                     size_t& i) {
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + m - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(ascii_either_case(first, needle[0]), ascii_either_case(last, needle[m - 1]))));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (ascii_equal_ignore_case(haystack + pos, needle, m)) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return n;
+}
+#endif
+
+}  // namespace
+
+bool utf8_validate(const StringView& text) {
+    static const ValidateFunction validate = utf8_select_validate();
+    return validate(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+std::u16string utf8_to_utf16(const StringView& text) {
+    return utf8_transcode<std::u16string>(text);
+}
+
+std::u32string utf8_to_utf32(const StringView& text) {
+    return utf8_transcode<std::u32string>(text);
+}
+
+void ascii_to_lower(char* data, size_t size) {
+    ascii_shift_range(data, size, 'A', 32);
+}
+
+void ascii_to_upper(char* data, size_t size) {
+    ascii_shift_range(data, size, 'a', -32);
+}
+
+int ascii_compare_ignore_case(const StringView& a, const StringView& b) {
+    size_t size = std::min(a.size(), b.size());
+    size_t i = 0;
+#ifdef UNICODE_X86
+    i = ascii_equal_prefix_sse2(a.data(), b.data(), size);
+#endif
+    for (; i < size; ++i) {
+        unsigned char ch_a = static_cast<unsigned char>(ascii_fold(a[i]));
+        unsigned char ch_b = static_cast<unsigned char>(ascii_fold(b[i]));
+        if (ch_a != ch_b) {
+            return (ch_a < ch_b ? -1 : 1);
+        }
+    }
+    return (a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0);
+}
+
+// Same first/last byte filter as String::find, with both cases of each
+// of the two bytes accepted.
+size_t ascii_find_ignore_case(const StringView& text, const StringView& pattern) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return n;
+    }
+    const char* haystack = text.data();
+    const char* needle = pattern.data();
+    size_t i = 0;
+#ifdef UNICODE_X86
+    size_t found = ascii_find_ignore_case_sse2(haystack, n, needle, m, i);
+    if (found != n) {
+        return found;
+    }
+#endif
+    for (; i + m <= n; ++i) {
+        if (ascii_equal_ignore_case(haystack + i, needle, m)) {
+            return i;
+        }
+    }
+    return n;
+}
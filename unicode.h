@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "string.h"
+
+// Byte-level routines behind String's UTF-8 and case-insensitive members.
+// Validation follows the Unicode well-formedness table (no overlongs,
+// surrogates or code points past U+10FFFF); the transcoders replace each
+// byte that does not start a well-formed sequence with U+FFFD. Case
+// functions only fold ASCII letters and leave other bytes untouched.
+bool utf8_validate(const StringView& text);
+
+std::u16string utf8_to_utf16(const StringView& text);
+
+std::u32string utf8_to_utf32(const StringView& text);
+
+void ascii_to_lower(char* data, size_t size);
+
+void ascii_to_upper(char* data, size_t size);
+
+int ascii_compare_ignore_case(const StringView& a, const StringView& b);
+
+// Returns text.size() when there is no match.
+size_t ascii_find_ignore_case(const StringView& text, const StringView& pattern);